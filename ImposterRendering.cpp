@@ -49,6 +49,7 @@
 #include "../../../../Common_3/Resources/ResourceLoader/Interfaces/IResourceLoader.h"
 
 #include "../../../../Common_3/Utilities/RingBuffer.h"
+#include "../../../../Common_3/Utilities/Threading/ThreadSystem.h"
 
 // Middleware packages
 #include "../../../../Common_3/Resources/AnimationSystem/Animation/SkeletonBatcher.h"
@@ -65,8 +66,27 @@
 #include "../../../../Common_3/Utilities/Interfaces/IMemory.h"
 
 #define TextureCount 180
+#define ImposterCaptureSize 256
 #define ImposterCountPerGroup 10000
 #define MaxImposterCount 200000
+#define ImposterClusterDim 10
+#define ImposterClusterSize (ImposterClusterDim * ImposterClusterDim)
+#define MaxImposterClusterCount (MaxImposterCount / ImposterClusterSize)
+static_assert(ImposterClusterSize <= AngleComputeGroupSize, "Raise AngleComputeGroupSize");
+#define SkinnedVertexStride (sizeof(float) * 8)
+#define ImposterBakeFrameCount 8
+#define ImposterBakeMagic 0x4B424D49
+#define ImposterBakeVersion 2
+#define MaxImposterBakeViewSize 4096
+#define MaxImposterBakeSliceCount 2048
+#define OctahedralGridSize 8
+#define MaxHiZMipCount 16
+#define MaxNearFieldCount 64
+#define MaxCrowdAnimCount 512
+#define VatFrameCount 32
+#define MaxVatCount 4096
+#define CrowdAnimTaskBatch 8
+#define MaxDataBufferCount 3
 
 ////////////////////////////////////////////////////////////////////////////////////
 //									Root Constant Blocks						  //
@@ -89,24 +109,175 @@ struct billboardsRootConstant
 	int frustumOn;
 	int imposter360;
 	int imposterCount;
+	int captureFrameStamp;
+	int bakedFlipbook;
+	float bakeFrame;
+	float phaseSpread;
+	int blendViews;
+	int compactedDraw;
+	int drawPhase;
+	int clusteredCull;
+	int nearFieldCount;
+	float nearFieldDistance;
+	int nearFieldHistogramPass;
+	int vatMaxCount;
+	float vatDistance;
+	int liveArchetype;
 }billboardRootConstantBlock;
 
+/// @brief rootConstant block for nearFieldRootConstant.
+struct NearFieldRootConstant
+{
+	mat4 rootTransform;
+	uint32_t boneCount;
+	uint32_t jointCount;
+	uint32_t poseFrameCount;
+	float clipDuration;
+	float animationTime;
+	float phaseSpread;
+	uint32_t crowdCount;
+	uint32_t imposter360;
+}nearFieldRootConstantBlock;
+
+/// @brief Bounds of ImposterClusterSize instances stored contiguously from mFirstInstance.
+struct ImposterCluster
+{
+	float4 mAabbMin;
+	float4 mAabbMax;
+	uint32_t mFirstInstance;
+	uint32_t mInstanceCount;
+	uint32_t mPad[2];
+};
+
+/// @brief rootConstant block for clusterCullRootConstant.
+struct ClusterCullRootConstant
+{
+	uint32_t clusterCount;
+	uint32_t imposterCount;
+	uint32_t shadowCasters;
+}clusterCullRootConstantBlock;
+
+/// @brief Inward culling planes of the main camera, then of the light for the shadow caster list.
+struct FrustumBlock
+{
+	vec4 mPlanes[6];
+	vec4 mLightPlanes[6];
+}frustumBlock;
+
+/// @brief Occlusion culling block, HiZ was built from last frame's depth with mHiZViewProj.
+struct OcclusionBlock
+{
+	mat4 mHiZViewProj;
+	mat4 mViewProj;
+	float2 mHiZSize;
+	uint32_t mHiZMipCount;
+	uint32_t mOcclusionOn;
+}occlusionBlock;
+
+/// @brief rootConstant block for HiZ build, one dispatch per mip.
+struct HiZBuildRootConstant
+{
+	uint32_t srcWidth;
+	uint32_t srcHeight;
+	uint32_t dstWidth;
+	uint32_t dstHeight;
+	uint32_t mipLevel;
+}hizBuildRootConstantBlock;
+
+enum OcclusionCounter
+{
+	OCCLUSION_COUNTER_TESTED = 0,
+	OCCLUSION_COUNTER_CANDIDATES,
+	OCCLUSION_COUNTER_RECOVERED,
+	OCCLUSION_COUNTER_COUNT
+};
+
+enum BonePaletteFormat
+{
+	//Full column major matrix per bone, 4 rows.
+	BONE_PALETTE_FORMAT_MAT4 = 0,
+	//Transposed affine matrix, the constant last row is dropped, 3 rows.
+	BONE_PALETTE_FORMAT_MAT3X4,
+	//Real and dual quaternion, rigid transforms only, 2 rows.
+	BONE_PALETTE_FORMAT_DUAL_QUAT,
+	BONE_PALETTE_FORMAT_COUNT
+};
+
+//Graphics command lists of a frame, submitted in this order. Capture and shadow are recorded on workers.
+enum RecordList
+{
+	RECORD_LIST_PROLOGUE = 0,
+	RECORD_LIST_CAPTURE,
+	RECORD_LIST_SHADOW,
+	RECORD_LIST_MAIN,
+	//Everything after the HiZ build, so the pyramid can be signalled to compute before it.
+	RECORD_LIST_OVERLAY,
+	RECORD_LIST_COUNT
+};
+
+/// @brief CPU side palette, float4 rows in gBonePaletteFormat, sized for the largest format.
 struct UniformDataBones
 {
-	mat4 mBoneMatrix[MAX_NUM_BONES];
+	vec4 mBoneRows[MAX_NUM_BONES * 4];
 }gUniformDataBones;
 
+/// @brief rootConstant block for animAccelRootConstant.
+struct AnimAccelRootConstant
+{
+	uint32_t jointCount;
+	uint32_t boneCount;
+	uint32_t levelCount;
+	uint32_t usePoseCache;
+	uint32_t poseFrameCount;
+	float clipDuration;
+	float animationTime;
+}animAccelRootConstantBlock;
+
+/// @brief Uniform block of the vertex animation draw.
+struct VatBlock
+{
+	uint32_t mVertexCount;
+	uint32_t mFrameCount;
+	float mClipDuration;
+	float mAnimationTime;
+	float mPhaseSpread;
+	uint32_t mImposter360;
+}vatBlock;
+
+/// @brief Clip pre-sampled into SoA joint local transforms, indexed [frame * mJointCount + joint].
+struct PoseCache
+{
+	uint32_t mFrameCount;
+	uint32_t mJointCount;
+	uint32_t mSampleRate;
+	float mDuration;
+	float4* pRotations;
+	float3* pTranslations;
+	float3* pScales;
+}gPoseCache;
+
+/// @brief rootConstant block for skinningRootConstant.
+struct SkinningRootConstant
+{
+	uint32_t vertexCount;
+	uint32_t inputStride;
+}skinningRootConstantBlock;
+
 ////////////////////////////////////////////////////////////////////////////////////
 //									Buffer - Wrap struct					      //
 ////////////////////////////////////////////////////////////////////////////////////
 struct MyBuffer
 {
-	//Update & Read data
+	//Update & Read data, one off uploads only, per frame data goes through the upload ring.
 	void UpdateData(void* source)
 	{
-		BufferUpdateDesc updateDesc = { buffer };
+		UpdateData(source, size);
+	}
+	void UpdateData(void* source, uint64_t dataSize)
+	{
+		BufferUpdateDesc updateDesc = { buffer, 0, dataSize };
 		beginUpdateResource(&updateDesc);
-		memcpy(updateDesc.pMappedData, source, size);
+		memcpy(updateDesc.pMappedData, source, dataSize);
 		endUpdateResource(&updateDesc, NULL);
 	}
 	void ReadData(void* dst)
@@ -120,6 +291,199 @@ struct MyBuffer
 	Buffer* buffer;
 };
 
+/// @brief Slot of a per frame upload, at the same offset inside every frame's block.
+struct UploadAllocation
+{
+	uint64_t mOffset;
+	uint64_t mSize;
+};
+
+/// @brief One persistently mapped buffer cut into a block per frame in flight, a block is rewritten only after its frame fence signaled.
+/// Slots are handed out linearly at init, so descriptors bind them by offset once and a frame's uploads land back to back in one block.
+struct UploadRing
+{
+	Buffer* pBuffer;
+	uint8_t* pMappedData;
+	uint64_t mAlignment;
+	uint64_t mBlockSize;
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+//									Imposter Atlas								  //
+////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Capture settings of one imposter type, independent from the window size.
+struct ImposterAtlasDesc
+{
+	uint32_t mViewWidth;
+	uint32_t mViewHeight;
+	uint32_t mViewCount;
+};
+
+/// @brief Every captured view of an imposter type lives in one slice of a texture array.
+struct ImposterAtlas
+{
+	RenderTarget* pColor;
+	RenderTarget* pDepth;
+	uint32_t mViewWidth;
+	uint32_t mViewHeight;
+	uint32_t mViewCount;
+};
+
+/// @brief Picks which atlas views get recaptured this frame.
+/// Views referenced by visible imposters come first (stalest first), the rest of the budget goes round-robin.
+struct ImposterCaptureScheduler
+{
+	uint32_t mLastCaptureStamp[TextureCount];
+	uint32_t mRefreshViews[TextureCount];
+	uint32_t mRefreshCount;
+	uint32_t mRoundRobinCursor;
+	uint32_t mFrameStamp;
+
+	//Stamp written into the angle bin readback of each frame in flight.
+	uint32_t mReadbackStamps[MaxDataBufferCount];
+
+	//Stats reported through the profiler counters.
+	uint32_t mVisibleViewCount;
+	uint32_t mMaxVisibleStaleness;
+	uint32_t mMaxStaleness;
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+//									Imposter Bake								  //
+////////////////////////////////////////////////////////////////////////////////////
+
+enum ImposterViewLayout
+{
+	//TextureCount rotations about Y from one fixed pitch.
+	IMPOSTER_VIEW_LAYOUT_RING_Y = 0,
+	//OctahedralGridSize^2 views over the upper hemisphere.
+	IMPOSTER_VIEW_LAYOUT_HEMI_OCTAHEDRAL,
+	//OctahedralGridSize^2 views over the full sphere.
+	IMPOSTER_VIEW_LAYOUT_FULL_OCTAHEDRAL,
+	IMPOSTER_VIEW_LAYOUT_COUNT
+};
+
+enum ImposterBakeCompression
+{
+	IMPOSTER_BAKE_COMPRESSION_NONE = 0,
+	//Runs of fully transparent texels are stored as a count, the rest as literals.
+	IMPOSTER_BAKE_COMPRESSION_ZERO_RLE = 1,
+};
+
+/// @brief Baked atlas file header, followed by a slice table of mFrameCount * mViewCount entries (frame major), then the slice data.
+struct ImposterBakeHeader
+{
+	uint32_t mMagic;
+	uint32_t mVersion;
+	uint32_t mViewWidth;
+	uint32_t mViewHeight;
+	uint32_t mViewCount;
+	uint32_t mFrameCount;
+	uint32_t mFormat;
+	uint32_t mCompression;
+	uint32_t mViewLayout;
+	float mSampleRate;
+	float mClipDuration;
+};
+
+/// @brief Slice layout of one imposterTextureHeap slot, read as imposterHeapLayouts.
+struct ImposterHeapLayout
+{
+	uint32_t mFrameCount;
+	uint32_t mViewCount;
+	uint32_t mViewLayout;
+	//0 for the ring layout.
+	uint32_t mViewGridSize;
+};
+
+/// @brief Assets of one character type, every archetype gets its own capture or bake.
+struct ImposterArchetypeDesc
+{
+	const char* pName;
+	const char* pMeshFile;
+	const char* pSkeletonFile;
+	const char* pClipFile;
+	const char* pDiffuseTexture;
+	const char* pBakeFile;
+};
+
+/// @brief Location of one (frame, view) slice, offset from the start of the file.
+struct ImposterBakeSlice
+{
+	uint64_t mOffset;
+	uint64_t mSize;
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+//									Frame Graph									  //
+////////////////////////////////////////////////////////////////////////////////////
+//Only the render targets passes hand to each other are tracked. Buffers, the HiZ pyramid and the scene depth
+//never leave the pass that uses them and keep their own barriers there.
+#define MaxFrameGraphAccesses 4
+
+enum FrameGraphResourceId
+{
+	FRAME_GRAPH_RESOURCE_ATLAS_COLOR = 0,
+	FRAME_GRAPH_RESOURCE_SHADOW_DEPTH,
+	FRAME_GRAPH_RESOURCE_BACK_BUFFER,
+	FRAME_GRAPH_RESOURCE_COUNT
+};
+
+//Render passes of a frame in submission order, each one records into RECORD_LIST_CAPTURE + pass.
+enum FrameGraphPassId
+{
+	FRAME_GRAPH_PASS_CAPTURE = 0,
+	FRAME_GRAPH_PASS_SHADOW,
+	FRAME_GRAPH_PASS_MAIN,
+	FRAME_GRAPH_PASS_COUNT
+};
+
+/// @brief Render target whose state the graph tracks, it is back in mInitialState at the end of every frame.
+/// Persistent contents outlive the frame, so a write to them keeps the pass alive.
+struct FrameGraphResource
+{
+	RenderTarget* pRenderTarget;
+	ResourceState mInitialState;
+	ResourceState mState;
+	bool mPersistent;
+};
+
+/// @brief State a pass needs one resource in.
+struct FrameGraphAccess
+{
+	uint32_t mResource;
+	ResourceState mState;
+	bool mWrite;
+};
+
+/// @brief Declared accesses of one pass, and the batched barriers compiled for it.
+struct FrameGraphPass
+{
+	const char* pName;
+	FrameGraphAccess mAccesses[MaxFrameGraphAccesses];
+	uint32_t mAccessCount;
+	bool mEnabled;
+	bool mSideEffects;
+	bool mCulled;
+	RenderTargetBarrier mBarriers[MaxFrameGraphAccesses];
+	uint32_t mBarrierCount;
+};
+
+/// @brief Rebuilt every frame: passes declare accesses, compile culls dead passes and places the barriers.
+struct FrameGraph
+{
+	FrameGraphResource mResources[FRAME_GRAPH_RESOURCE_COUNT];
+	FrameGraphPass mPasses[FRAME_GRAPH_PASS_COUNT];
+	//Returns every resource to its initial state, recorded at the end of the main pass.
+	RenderTargetBarrier mFinalBarriers[FRAME_GRAPH_RESOURCE_COUNT];
+	uint32_t mFinalBarrierCount;
+
+	//Stats for the debug text overlay.
+	uint32_t mCulledCount;
+	uint32_t mBarrierCount;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////
 //									Setups										  //
 ////////////////////////////////////////////////////////////////////////////////////
@@ -129,6 +493,22 @@ Queue* queue = NULL;
 GpuCmdRing* gGraphicsCmdRing = NULL;
 Semaphore* pImageAcquiredSemaphore = NULL;
 
+//Async compute, culling and animation run on their own queue ahead of the graphics work reading them.
+Queue* pComputeQueue = NULL;
+GpuCmdRing* gComputeCmdRing = NULL;
+//Graphics signals once the HiZ pyramid is built, next frame's culling waits on it.
+Semaphore* pHiZBuiltSemaphore = NULL;
+bool gHiZBuiltSemaphorePending = false;
+bool gAsyncComputeLastFrame = false;
+
+//Render target array index written from the vertex shader, queried at init. Without it the capture draws per view.
+bool gMultiViewCaptureSupported = false;
+
+//One-off submissions outside the frame ring (imposter bake).
+CmdPool* pBakeCmdPool = NULL;
+Cmd* pBakeCmd = NULL;
+Fence* pBakeFence = NULL;
+
 //Geoms
 Geometry* pGeom = NULL;
 GeometryData* pGeomData = NULL;
@@ -138,13 +518,27 @@ Sampler* pDefaultSampler = NULL;
 Sampler* pShadowSampler = NULL;
 Texture* pTextureDiffuse = NULL;
 
-//Anim File Paths
-const char* gStickFigureName = "stormtrooper/skeleton.ozz";
-const char* gClipName = "stormtrooper/animations/dance.ozz";
-const char* gDiffuseTexture = "Stormtrooper_D.tex";
+//Shipped archetypes, one row per character type in the crowd.
+const ImposterArchetypeDesc gShippedArchetypeDescs[] =
+{
+	{ "stormtrooper", "stormtrooper/riggedMesh.bin", "stormtrooper/skeleton.ozz", "stormtrooper/animations/dance.ozz", "Stormtrooper_D.tex", "stormtrooper.imposter" },
+};
+const uint32_t gShippedArchetypeCount = sizeof(gShippedArchetypeDescs) / sizeof(gShippedArchetypeDescs[0]);
+static_assert(sizeof(gShippedArchetypeDescs) / sizeof(gShippedArchetypeDescs[0]) <= MaxImposterArchetypes, "Raise MaxImposterArchetypes");
+
+//Archetype registry the app runs with, the shipped rows then the variants --archetype-variants adds.
+ImposterArchetypeDesc gImposterArchetypeDescs[MaxImposterArchetypes] = {};
+uint32_t gImposterArchetypeCount = 0;
+char gArchetypeVariantNames[MaxImposterArchetypes][64] = {};
+char gArchetypeVariantBakeFiles[MaxImposterArchetypes][64] = {};
+
+//Archetype whose mesh, rig and clip drive live capture, near field and VAT. Every archetype's assets are loaded,
+//the bake switches through them, otherwise the others only ever draw from their baked atlases.
+uint32_t gLiveArchetype = 0;
 
 //Profiler
 ProfileToken   gGpuProfileToken;
+ProfileToken   gComputeProfileToken;
 uint32_t       gFrameIndex = 0;
 
 //Fonts
@@ -154,7 +548,8 @@ uint32_t gFontID = 0;
 static HiresTimer gAnimationUpdateTimer;
 char debugUIText[64] = { 0 };
 float dtSave;
-const uint32_t gDataBufferCount = 2;
+//Frames in flight, per frame resources exist MaxDataBufferCount times and only the first gDataBufferCount are cycled.
+uint32_t gDataBufferCount = 2;
 UIComponent* pStandaloneControlsGUIWindow = NULL;
 LoadActionsDesc clearLoadAction{};
 
@@ -166,6 +561,15 @@ Shader* pShaderSkinning = NULL;
 Shader* pShaderQuad = NULL;
 Shader* pShaderAngleCompute = NULL;
 Shader* pShaderAnimAccelerator = NULL;
+Shader* pShaderSkinningCompute = NULL;
+Shader* pShaderPosedMesh = NULL;
+Shader* pShaderPosedMeshMultiView = NULL;
+Shader* pShaderHiZBuild = NULL;
+Shader* pShaderOcclusionRetest = NULL;
+Shader* pShaderClusterCull = NULL;
+Shader* pShaderNearFieldPalette = NULL;
+Shader* pShaderSkinningInstanced = NULL;
+Shader* pShaderVatMesh = NULL;
 
 ////////////////////////////////////////////////////////////////////////////////////
 //									DescriptorSet								  //
@@ -173,8 +577,18 @@ Shader* pShaderAnimAccelerator = NULL;
 DescriptorSet* pDescriptorSet = NULL;
 DescriptorSet* pDescriptorSetSkinning[2] = { NULL };
 DescriptorSet* pDescriptorQuad = { NULL };
+DescriptorSet* pDescriptorSetImposterHeap = NULL;
 DescriptorSet* pDescriptorSetAnimAccelerator[2] = { NULL };
 DescriptorSet* pDescriptorSetCompAngleCompute = NULL;
+DescriptorSet* pDescriptorSetSkinningCompute = NULL;
+DescriptorSet* pDescriptorSetPosedMesh = NULL;
+DescriptorSet* pDescriptorSetPosedMeshMultiView[2] = { NULL };
+DescriptorSet* pDescriptorSetHiZBuild = NULL;
+DescriptorSet* pDescriptorSetOcclusionRetest = NULL;
+DescriptorSet* pDescriptorSetClusterCull = NULL;
+DescriptorSet* pDescriptorSetNearFieldPalette[2] = { NULL };
+DescriptorSet* pDescriptorSetSkinningInstanced[2] = { NULL };
+DescriptorSet* pDescriptorSetVatMesh[2] = { NULL };
 
 ////////////////////////////////////////////////////////////////////////////////////
 //									RootSignatures								  //
@@ -184,6 +598,15 @@ RootSignature* pRootSignatureSkinning = NULL;
 RootSignature* pRootSignatureQuad = NULL;
 RootSignature* pRootSigAnimAccelerator = NULL;
 RootSignature* pRootSigCompAngleCompute = NULL;
+RootSignature* pRootSigSkinningCompute = NULL;
+RootSignature* pRootSignaturePosedMesh = NULL;
+RootSignature* pRootSignaturePosedMeshMultiView = NULL;
+RootSignature* pRootSigHiZBuild = NULL;
+RootSignature* pRootSigOcclusionRetest = NULL;
+RootSignature* pRootSigClusterCull = NULL;
+RootSignature* pRootSigNearFieldPalette = NULL;
+RootSignature* pRootSignatureSkinningInstanced = NULL;
+RootSignature* pRootSignatureVatMesh = NULL;
 
 ////////////////////////////////////////////////////////////////////////////////////
 //									Pipeline									  //
@@ -191,35 +614,132 @@ RootSignature* pRootSigCompAngleCompute = NULL;
 Pipeline* pPlaneDrawPipeline = NULL;
 Pipeline* pPipelineSkinning = NULL;
 Pipeline* pPipelineQuad = NULL;
+Pipeline* pPipelineQuadShadow = NULL;
 Pipeline* pPipelineAnimAccelerator = NULL;
 Pipeline* pPipelineCompAngleCompute = NULL;
+Pipeline* pPipelineSkinningCompute = NULL;
+Pipeline* pPipelinePosedMesh = NULL;
+Pipeline* pPipelinePosedMeshMultiView = NULL;
+Pipeline* pPipelineHiZBuild = NULL;
+Pipeline* pPipelineOcclusionRetest = NULL;
+Pipeline* pPipelineClusterCull = NULL;
+Pipeline* pPipelineNearFieldPalette = NULL;
+Pipeline* pPipelineSkinningInstanced = NULL;
+Pipeline* pPipelineVatMesh = NULL;
+
+//Indirect instanced quad draw, args filled by the angle compute.
+CommandSignature* pCmdSignatureQuad = NULL;
+//Indirect angle compute, one group per surviving cluster.
+CommandSignature* pCmdSignatureClusterDispatch = NULL;
+CommandSignature* pCmdSignatureRetestDispatch = NULL;
+//Instanced skinned draw of the near field, instance count filled by the angle compute.
+CommandSignature* pCmdSignatureNearField = NULL;
+//Instanced vertex animation draw of the mid field.
+CommandSignature* pCmdSignatureVat = NULL;
 
 ////////////////////////////////////////////////////////////////////////////////////
 //									Buffers										  //
 ////////////////////////////////////////////////////////////////////////////////////
 //static
 MyBuffer* pBufferJointParentsIndex = NULL;
+//Joints sorted by hierarchy depth and the [first, count] range of every depth level.
+MyBuffer* pBufferJointLevelOrder = NULL;
+MyBuffer* pBufferJointLevelRanges = NULL;
 MyBuffer* pBufferQuadDirection = NULL;
 MyBuffer* pBufferPlaneVertex = NULL;
 MyBuffer* pBufferQuadVertex = NULL;
 MyBuffer* pBufferQuadsPosition = NULL;
+MyBuffer* pBufferQuadPhases = NULL;
+MyBuffer* pBufferQuadArchetypes = NULL;
+MyBuffer* pBufferImposterViewMats = NULL;
+MyBuffer* pBufferImposterHeapLayouts = NULL;
 
 //Dynamic
-//Transformation Matrices Buffers.
-MyBuffer* pBufferPlaneTransformations[2] = { NULL };
-MyBuffer* pBufferBoneTransformations[2] = { NULL };
-MyBuffer* pBufferQuadTransformations[2] = { NULL };
+//Per frame uploads. Plane and quads share the camera block.
+UploadRing gUploadRing = {};
+UploadAllocation gUploadCamera = {};
+UploadAllocation gUploadBones = {};
+UploadAllocation gUploadJointModelMats = {};
+UploadAllocation gUploadFrustum = {};
+UploadAllocation gUploadOcclusion = {};
+UploadAllocation gUploadVatBlock = {};
 
 //Anim Accel calc resources.
-MyBuffer* pBufferJointWorldMats[2] = { NULL };
-MyBuffer* pBufferJointModelMats[2] = { NULL };
-MyBuffer* pBufferJointScales[2] = { NULL };
-MyBuffer* pBufferBoneWorldMats[2] = { NULL };
+MyBuffer* pBufferJointWorldMats[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferJointModelMats[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferJointScales[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferBoneWorldMats[MaxDataBufferCount] = { NULL };
+
+//Final skinning matrices read by every skinning path, written by the accelerator or copied from the uploaded bones.
+MyBuffer* pBufferBonePalette[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferJointWorldMatsReadback[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferJointRemaps = NULL;
+MyBuffer* pBufferInverseBindPoses = NULL;
+bool gJointWorldMatsReadbackReady[MaxDataBufferCount] = {};
+uint32_t gJointLevelCount = 0;
+
+//Pose cache streams, same layout as gPoseCache.
+MyBuffer* pBufferPoseRotations = NULL;
+MyBuffer* pBufferPoseTranslations = NULL;
+MyBuffer* pBufferPoseScales = NULL;
+
+//Near field, the closest instances drawn as real skinned meshes.
+MyBuffer* pBufferNearFieldArgsReset = NULL;
+MyBuffer* pBufferNearFieldIndices[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferNearFieldArgs[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferNearFieldPalettes[MaxDataBufferCount] = { NULL };
+//Distance histogram of near field candidates, then the boundary bin's slot counter.
+MyBuffer* pBufferNearFieldHistogram[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferNearFieldHistogramReset = NULL;
+//Skinning matrices of the CPU animated crowd, written by the workers into the mapped slot.
+MyBuffer* pBufferCrowdPalettes[MaxDataBufferCount] = { NULL };
+
+//Mid field, pre-skinned vertices of VatFrameCount clip samples drawn without bone math.
+MyBuffer* pBufferVertexAnimation = NULL;
+MyBuffer* pBufferVatArgsReset = NULL;
+MyBuffer* pBufferVatIndices[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferVatArgs[MaxDataBufferCount] = { NULL };
+bool gVatBakeRequested = false;
+//Archetype whose mesh the VAT holds, UINT32_MAX before the first bake.
+uint32_t gVatBakedArchetype = UINT32_MAX;
+
+//Posed vertices written by the skinning compute on frames that capture.
+MyBuffer* pBufferSkinnedVertices[MaxDataBufferCount] = { NULL };
+bool gPosedMeshReady = false;
 
 //
-MyBuffer* pBufferQuadAngles[2] = { NULL };
+MyBuffer* pBufferQuadAngles[MaxDataBufferCount] = { NULL };
+
+//Last frame stamp each view was referenced by a visible imposter, read back once its frame fence signaled.
+MyBuffer* pBufferAngleBinUsage = NULL;
+MyBuffer* pBufferAngleBinReadback[MaxDataBufferCount] = { NULL };
+
+//Views to capture this frame, indexed by instance id in single pass capture.
+MyBuffer* pBufferCaptureViewList[MaxDataBufferCount] = { NULL };
+
+//Compacted visible instance indices and their indirect draw args.
+MyBuffer* pBufferVisibleIndices[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferQuadIndirectArgs[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferQuadIndirectArgsReset = NULL;
+//Instances inside the light's frustum, drawn by the shadow pass with the same draw args layout.
+MyBuffer* pBufferShadowIndices[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferShadowIndirectArgs[MaxDataBufferCount] = { NULL };
+
+//Second occlusion phase: instances occluded by last frame's HiZ, re-tested against this frame's.
+MyBuffer* pBufferOcclusionCandidates[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferRetestIndices[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferRetestIndirectArgs[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferRetestDispatchArgs[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferOcclusionCounters[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferOcclusionCountersReset = NULL;
+MyBuffer* pBufferOcclusionReadback[MaxDataBufferCount] = { NULL };
+
+//Instance clusters, culled before any per-instance work.
+MyBuffer* pBufferImposterClusters = NULL;
+MyBuffer* pBufferVisibleClusters[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferClusterDispatchArgs[MaxDataBufferCount] = { NULL };
+MyBuffer* pBufferClusterDispatchArgsReset = NULL;
 MyBuffer* pBufferShadowTransformations = {NULL};
-MyBuffer* pBufferFrustumPlanes = {NULL};
 
 ////////////////////////////////////////////////////////////////////////////////////
 //									Datas										  //
@@ -230,6 +750,24 @@ mat4 imposterProjMatrix;
 mat4 imposterViewMatrix;
 mat4 imposterRotationMatrices[TextureCount];
 
+//Model to view matrix of every capture view, indexed by instance id in single pass capture.
+mat4 imposterCaptureViewMats[TextureCount];
+uint32_t gImposterViewLayout = IMPOSTER_VIEW_LAYOUT_RING_Y;
+const char* gImposterViewLayoutNames[IMPOSTER_VIEW_LAYOUT_COUNT] = { "Ring Y (180)", "Hemi Octahedral (64)", "Full Octahedral (64)" };
+
+//Layout of every bone palette, the shaders reading or writing one are compiled per format.
+uint32_t gBonePaletteFormat = BONE_PALETTE_FORMAT_MAT4;
+bool gBonePaletteReloadRequested = false;
+//Skinning matrices of the live clip carry scale, dual quaternions cannot represent it and fall back to 3x4 rows.
+bool gRigHasScale = false;
+const uint32_t gBonePaletteRows[BONE_PALETTE_FORMAT_COUNT] = { 4, 3, 2 };
+const char* gBonePaletteFormatNames[BONE_PALETTE_FORMAT_COUNT] = { "Matrix 4x4", "Matrix 3x4", "Dual Quaternion" };
+const char* gSkinningVertShaders[BONE_PALETTE_FORMAT_COUNT] = { "skinning.vert", "skinning_Mat3x4.vert", "skinning_DualQuat.vert" };
+const char* gSkinningInstancedVertShaders[BONE_PALETTE_FORMAT_COUNT] = { "skinningInstanced.vert", "skinningInstanced_Mat3x4.vert", "skinningInstanced_DualQuat.vert" };
+const char* gSkinningCompShaders[BONE_PALETTE_FORMAT_COUNT] = { "SkinningCompute.comp", "SkinningCompute_Mat3x4.comp", "SkinningCompute_DualQuat.comp" };
+const char* gAnimAccelCompShaders[BONE_PALETTE_FORMAT_COUNT] = { "AnimationAccelerator.comp", "AnimationAccelerator_Mat3x4.comp", "AnimationAccelerator_DualQuat.comp" };
+const char* gNearFieldPaletteCompShaders[BONE_PALETTE_FORMAT_COUNT] = { "NearFieldPalette.comp", "NearFieldPalette_Mat3x4.comp", "NearFieldPalette_DualQuat.comp" };
+
 //Matrix for shadowing (light's point of view).
 mat4 lightProjMat;
 
@@ -239,9 +777,15 @@ MatrixBlock lightMatrixBlock;
 //Main camera matrix.
 CameraMatrix viewProjMatMainCamera;
 
-vec4 frustumPlanes[6];
 int imposterCount = 10000;
 
+ImposterCaptureScheduler gCaptureScheduler = {};
+
+//Capture runs on its own fixed step, imposters hold the last capture in between.
+float gCaptureTickAccumulator = 0.f;
+bool gCaptureTick = true;
+uint32_t angleBinUsage[TextureCount];
+
 ////////////////////////////////////////////////////////////////////////////////////
 //									Cameras										  //
 ////////////////////////////////////////////////////////////////////////////////////
@@ -254,15 +798,32 @@ ICameraController* light = NULL;
 //									RTVs										  //
 ////////////////////////////////////////////////////////////////////////////////////
 
-//For capturing.
-RenderTarget* rts[TextureCount] = { NULL };
+//For capturing, one slice per view.
+ImposterAtlasDesc gImposterAtlasDesc = { ImposterCaptureSize, ImposterCaptureSize, TextureCount };
+ImposterAtlas gImposterAtlas = {};
 RenderTarget* pDepthBuffer = NULL;
 
-//For passing to shader.
-Texture* rtTextures[TextureCount] = { NULL };
+//Min depth pyramid of the main view (reverse Z, so farthest depth per texel).
+Texture* pTextureHiZ = NULL;
+uint32_t gHiZMipCount = 0;
+bool gHiZValid = false;
+mat4 gHiZViewProj;
+uint32_t gOcclusionCounters[OCCLUSION_COUNTER_COUNT] = {};
+bool gOcclusionReadbackReady[MaxDataBufferCount] = {};
+
+//Baked (frame, view) slices per archetype, streamed from their baked atlas files.
+//Baked mode plays every bake at the live archetype's header rate, each slot is indexed with its own layout.
+Texture* pImposterBakeTextures[MaxImposterArchetypes] = {};
+ImposterBakeHeader gImposterBakeHeader = {};
+ImposterBakeHeader gImposterBakeHeaders[MaxImposterArchetypes] = {};
+
+//Bindless imposter textures, instances index the heap with their archetype id.
+Texture* gImposterTextureHeap[ImposterTextureHeapSize] = {};
+bool gImposterBakeRequested = false;
+bool gPoseCacheRebuildRequested = false;
+bool gImposterBakeAndExit = false;
 
 //For shadow rendering.
-RenderTarget* shadowRT = NULL;
 RenderTarget* shadowDepthRT = NULL;
 
 
@@ -275,6 +836,76 @@ ClipController* gClipController = NULL;
 Clip* gClip = NULL;
 Rig* gStickFigureRig = NULL;
 
+/// @brief Loaded assets of one archetype, the globals above, pGeom, pGeomData and pTextureDiffuse alias the live one's.
+struct ImposterArchetype
+{
+	Rig* pRig;
+	Clip* pClip;
+	ClipController* pClipController;
+	Animation* pAnimation;
+	AnimatedObject* pAnimObject;
+	Geometry* pGeom;
+	GeometryData* pGeomData;
+	Texture* pDiffuse;
+};
+
+ImposterArchetype gImposterArchetypes[MaxImposterArchetypes] = {};
+
+/// @brief Independently timed copy of the clip on the shared rig, updated on a worker thread.
+struct CrowdAnim
+{
+	ClipController* pClipController;
+	Animation* pAnimation;
+	AnimatedObject* pAnimObject;
+	float mAnimationTime;
+};
+
+/// @brief Shared input of one batch of crowd animation tasks.
+struct CrowdAnimTaskData
+{
+	float mDeltaTime;
+	bool mBindPose;
+	bool mUsePoseCache;
+	uint32_t mCount;
+	uint32_t mFormat;
+	vec4* pPalettes;
+};
+
+CrowdAnim gCrowdAnims[MaxCrowdAnimCount] = {};
+CrowdAnimTaskData gCrowdAnimTaskData = {};
+ThreadSystem* pThreadSystem = NULL;
+static HiresTimer gCrowdAnimTimer;
+
+/// @brief Input of the worker tasks recording the capture and shadow lists.
+struct PassRecordTaskData
+{
+	class ImposterRendering* pApp;
+	Cmd** ppCmds;
+};
+
+PassRecordTaskData gPassRecordTaskData = {};
+static HiresTimer gCmdRecordTimer;
+FrameGraph gFrameGraph = {};
+
+/// @brief Input sample time of a frame in flight, resolved against its frame end timestamp once its fence is seen signaled.
+struct FrameLatency
+{
+	Fence* pFence;
+	int64_t mInputTime;
+};
+
+FrameLatency gFrameLatency[MaxDataBufferCount] = {};
+int64_t gInputSampleTime = 0;
+float gInputLatencyMs = 0.f;
+
+//Frame end timestamp per frame in flight, each resolved into its own slot of the readback.
+QueryPool* pLatencyQueryPool = NULL;
+MyBuffer* pBufferLatencyReadback = NULL;
+uint64_t gLatencyTimestamps[MaxDataBufferCount] = {};
+double gGpuTimestampFrequency = 0.0;
+//GPU and CPU clocks sampled together, queried at init. Without it latency ends when the fence is seen signaled.
+bool gGpuClockCalibrationSupported = false;
+
 //--------------------------------------------------------------------------------------------
 // UI DATA
 //--------------------------------------------------------------------------------------------
@@ -300,7 +931,31 @@ struct UIData
 		bool mFrustumOn = true;
 		bool mUsingMainCam = true;
 		bool mUsing360Imposter = false;
+		bool mPreSkinCompute = true;
+		bool mSinglePassCapture = true;
+		bool mCompactedDraws = true;
+		bool mOcclusionCulling = true;
+		bool mClusterCulling = true;
+		bool mUseBakedImposters = false;
 		int imposterCount = 10000;
+		int captureViewsPerFrame = TextureCount;
+		int captureTickRate = 30;
+		bool mAsyncCompute = true;
+		bool mParallelRecording = true;
+		int framesInFlight = 2;
+		bool mLateLatchCamera = true;
+		float phaseSpread = 1.f;
+		uint32_t viewLayout = IMPOSTER_VIEW_LAYOUT_RING_Y;
+		uint32_t bonePaletteFormat = BONE_PALETTE_FORMAT_MAT4;
+		bool mBlendViews = true;
+		bool mNearFieldSkinning = true;
+		int nearFieldCount = 16;
+		float nearFieldDistance = 10.f;
+		int crowdAnimCount = 128;
+		bool mUsePoseCache = true;
+		int poseCacheSampleRate = 30;
+		bool mVatMidField = true;
+		float vatDistance = 50.f;
 	};
 	GeneralSettingsData mGeneralSettings;
 };
@@ -338,6 +993,200 @@ void ResetImposterCountCallback(void* userData)
 	imposterCount = gUIData.mGeneralSettings.imposterCount;
 }
 
+void BakeImpostersCallback(void* userData)
+{
+	gImposterBakeRequested = true;
+}
+
+void PoseCacheSampleRateCallback(void* userData)
+{
+	//Rebuilding re-samples the whole clip, only do it once the slider is released.
+	gPoseCacheRebuildRequested = true;
+}
+
+//--------------------------------------------------------------------------------------------
+// TASK FUNCTIONS
+//--------------------------------------------------------------------------------------------
+void SamplePoseCache(float time, const mat4& rootTransform, mat4* pWorldMats)
+{
+	//Lerp the two nearest samples of the looping table, then resolve the hierarchy in joint order.
+	const int16_t* pParents = gStickFigureRig->mSkeleton.joint_parents().begin();
+	const float frame = fmodf(time / gPoseCache.mDuration, 1.f) * (float)gPoseCache.mFrameCount;
+	const uint32_t frame0 = min((uint32_t)frame, gPoseCache.mFrameCount - 1);
+	const uint32_t frame1 = (frame0 + 1) % gPoseCache.mFrameCount;
+	const float t = frame - (float)frame0;
+
+	for (uint32_t joint = 0; joint < gPoseCache.mJointCount; ++joint)
+	{
+		const uint32_t index0 = frame0 * gPoseCache.mJointCount + joint;
+		const uint32_t index1 = frame1 * gPoseCache.mJointCount + joint;
+		const float4& q0 = gPoseCache.pRotations[index0];
+		const float4& q1 = gPoseCache.pRotations[index1];
+		const float3& t0 = gPoseCache.pTranslations[index0];
+		const float3& t1 = gPoseCache.pTranslations[index1];
+		const float3& s0 = gPoseCache.pScales[index0];
+		const float3& s1 = gPoseCache.pScales[index1];
+
+		const Quat rotation = slerp(t, Quat(q0.x, q0.y, q0.z, q0.w), Quat(q1.x, q1.y, q1.z, q1.w));
+		const vec3 translation = lerp(t, vec3(t0.x, t0.y, t0.z), vec3(t1.x, t1.y, t1.z));
+		const vec3 scale = lerp(t, vec3(s0.x, s0.y, s0.z), vec3(s1.x, s1.y, s1.z));
+
+		const mat4 local = mat4(rotation, translation) * mat4::scale(scale);
+		pWorldMats[joint] = (pParents[joint] < 0 ? rootTransform : pWorldMats[pParents[joint]]) * local;
+	}
+}
+
+uint32_t BuildBonePalette(uint32_t format, const mat4* pJointWorldMats, vec4* pRows)
+{
+	//Skinning matrices of the mesh bones packed as float4 rows, returns the row count written.
+	const uint32_t boneCount = pGeomData->mJointCount;
+	const uint32_t* pRemaps = pGeomData->pJointRemaps;
+	const mat4* pInverseBindPoses = pGeomData->pInverseBindPoses;
+
+	switch (format)
+	{
+	case BONE_PALETTE_FORMAT_MAT3X4:
+		for (uint32_t bone = 0; bone < boneCount; ++bone, pRows += 3)
+		{
+			const mat4 rows = transpose(pJointWorldMats[pRemaps[bone]] * pInverseBindPoses[bone]);
+			pRows[0] = rows.getCol0();
+			pRows[1] = rows.getCol1();
+			pRows[2] = rows.getCol2();
+		}
+		break;
+	case BONE_PALETTE_FORMAT_DUAL_QUAT:
+		//Four bones per iteration, one per vec4 lane, so the matrix to quaternion conversion runs branch free.
+		for (uint32_t first = 0; first < boneCount; first += 4)
+		{
+			vec4 m00, m11, m22, m01, m10, m02, m20, m12, m21, tx, ty, tz;
+			vec4 pickX, pickY, pickZ, pickW;
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				//Tail lanes run on identity and are not written.
+				const uint32_t bone = first + lane;
+				const mat4 skin = bone < boneCount ? pJointWorldMats[pRemaps[bone]] * pInverseBindPoses[bone] : mat4::identity();
+				m00.setElem(lane, skin.getCol0().getX());
+				m10.setElem(lane, skin.getCol0().getY());
+				m20.setElem(lane, skin.getCol0().getZ());
+				m01.setElem(lane, skin.getCol1().getX());
+				m11.setElem(lane, skin.getCol1().getY());
+				m21.setElem(lane, skin.getCol1().getZ());
+				m02.setElem(lane, skin.getCol2().getX());
+				m12.setElem(lane, skin.getCol2().getY());
+				m22.setElem(lane, skin.getCol2().getZ());
+				tx.setElem(lane, skin.getCol3().getX());
+				ty.setElem(lane, skin.getCol3().getY());
+				tz.setElem(lane, skin.getCol3().getZ());
+			}
+
+			//Scaled rigs fall back to 3x4 rows, see gRigHasScale. Unit columns keep the diagonal terms below exact.
+			const vec4 invLength0 = rsqrtPerElem(mulPerElem(m00, m00) + mulPerElem(m10, m10) + mulPerElem(m20, m20));
+			const vec4 invLength1 = rsqrtPerElem(mulPerElem(m01, m01) + mulPerElem(m11, m11) + mulPerElem(m21, m21));
+			const vec4 invLength2 = rsqrtPerElem(mulPerElem(m02, m02) + mulPerElem(m12, m12) + mulPerElem(m22, m22));
+			m00 = mulPerElem(m00, invLength0);
+			m10 = mulPerElem(m10, invLength0);
+			m20 = mulPerElem(m20, invLength0);
+			m01 = mulPerElem(m01, invLength1);
+			m11 = mulPerElem(m11, invLength1);
+			m21 = mulPerElem(m21, invLength1);
+			m02 = mulPerElem(m02, invLength2);
+			m12 = mulPerElem(m12, invLength2);
+			m22 = mulPerElem(m22, invLength2);
+
+			//Shepperd: 4x^2, 4y^2, 4z^2 and 4w^2 from the diagonal, products of two components from the off diagonal.
+			const vec4 one(1.f);
+			const vec4 xx = one + m00 - m11 - m22;
+			const vec4 yy = one - m00 + m11 - m22;
+			const vec4 zz = one - m00 - m11 + m22;
+			const vec4 ww = one + m00 + m11 + m22;
+			const vec4 xy = m01 + m10;
+			const vec4 xz = m02 + m20;
+			const vec4 yz = m12 + m21;
+			const vec4 wx = m21 - m12;
+			const vec4 wy = m02 - m20;
+			const vec4 wz = m10 - m01;
+
+			//The largest square is the well conditioned divisor, near 180 degrees w is not. Ties go to x, y, z then w like PackBone.
+			const vec4 largest = maxPerElem(maxPerElem(xx, yy), maxPerElem(zz, ww));
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				const bool x = xx.getElem(lane) == largest.getElem(lane);
+				const bool y = !x && yy.getElem(lane) == largest.getElem(lane);
+				const bool z = !x && !y && zz.getElem(lane) == largest.getElem(lane);
+				pickX.setElem(lane, x ? 1.f : 0.f);
+				pickY.setElem(lane, y ? 1.f : 0.f);
+				pickZ.setElem(lane, z ? 1.f : 0.f);
+				pickW.setElem(lane, !x && !y && !z ? 1.f : 0.f);
+			}
+
+			//Every candidate is the quaternion scaled by four times its picked component, normalizing drops the factor.
+			vec4 qx = mulPerElem(pickX, xx) + mulPerElem(pickY, xy) + mulPerElem(pickZ, xz) + mulPerElem(pickW, wx);
+			vec4 qy = mulPerElem(pickX, xy) + mulPerElem(pickY, yy) + mulPerElem(pickZ, yz) + mulPerElem(pickW, wy);
+			vec4 qz = mulPerElem(pickX, xz) + mulPerElem(pickY, yz) + mulPerElem(pickZ, zz) + mulPerElem(pickW, wz);
+			vec4 qw = mulPerElem(pickX, wx) + mulPerElem(pickY, wy) + mulPerElem(pickZ, wz) + mulPerElem(pickW, ww);
+			const vec4 invLength = rsqrtPerElem(mulPerElem(qx, qx) + mulPerElem(qy, qy) + mulPerElem(qz, qz) + mulPerElem(qw, qw));
+			qx = mulPerElem(qx, invLength);
+			qy = mulPerElem(qy, invLength);
+			qz = mulPerElem(qz, invLength);
+			qw = mulPerElem(qw, invLength);
+
+			//dual = 0.5 * (t, 0) * real
+			const vec4 dx = (mulPerElem(tx, qw) + mulPerElem(ty, qz) - mulPerElem(tz, qy)) * 0.5f;
+			const vec4 dy = (mulPerElem(ty, qw) + mulPerElem(tz, qx) - mulPerElem(tx, qz)) * 0.5f;
+			const vec4 dz = (mulPerElem(tz, qw) + mulPerElem(tx, qy) - mulPerElem(ty, qx)) * 0.5f;
+			const vec4 dw = (mulPerElem(tx, qx) + mulPerElem(ty, qy) + mulPerElem(tz, qz)) * -0.5f;
+
+			const uint32_t laneCount = min(boneCount - first, 4u);
+			for (uint32_t lane = 0; lane < laneCount; ++lane, pRows += 2)
+			{
+				pRows[0] = vec4(qx.getElem(lane), qy.getElem(lane), qz.getElem(lane), qw.getElem(lane));
+				pRows[1] = vec4(dx.getElem(lane), dy.getElem(lane), dz.getElem(lane), dw.getElem(lane));
+			}
+		}
+		break;
+	default:
+		for (uint32_t bone = 0; bone < boneCount; ++bone, pRows += 4)
+		{
+			const mat4 skin = pJointWorldMats[pRemaps[bone]] * pInverseBindPoses[bone];
+			pRows[0] = skin.getCol0();
+			pRows[1] = skin.getCol1();
+			pRows[2] = skin.getCol2();
+			pRows[3] = skin.getCol3();
+		}
+		break;
+	}
+
+	return boneCount * gBonePaletteRows[format];
+}
+
+void UpdateCrowdAnimTask(void* pUserData, uint64_t batch)
+{
+	//Sample, local to model and skinning matrices of a few objects, written straight into their palette slice.
+	const CrowdAnimTaskData* pData = (const CrowdAnimTaskData*)pUserData;
+	const uint32_t first = (uint32_t)batch * CrowdAnimTaskBatch;
+	const uint32_t last = min(first + CrowdAnimTaskBatch, pData->mCount);
+
+	for (uint32_t i = first; i < last; ++i)
+	{
+		AnimatedObject* pAnimObject = gCrowdAnims[i].pAnimObject;
+		if (pData->mUsePoseCache)
+		{
+			gCrowdAnims[i].pClipController->Update(pData->mDeltaTime);
+			SamplePoseCache(gCrowdAnims[i].mAnimationTime, pAnimObject->mRootTransform, pAnimObject->mJointWorldMats.begin());
+		}
+		else
+		{
+			pAnimObject->Update(pData->mDeltaTime);
+			if (!pData->mBindPose)
+				pAnimObject->ComputePose(pAnimObject->mRootTransform);
+			else
+				pAnimObject->ComputeBindPose(pAnimObject->mRootTransform);
+		}
+
+		BuildBonePalette(pData->mFormat, pAnimObject->mJointWorldMats.begin(), pData->pPalettes + i * pGeomData->mJointCount * gBonePaletteRows[pData->mFormat]);
+	}
+}
+
 //--------------------------------------------------------------------------------------------
 // APP CODE
 //--------------------------------------------------------------------------------------------
@@ -347,6 +1196,9 @@ class ImposterRendering: public IApp
 	bool Init()
 	{
 		initHiresTimer(&gAnimationUpdateTimer);
+		initHiresTimer(&gCrowdAnimTimer);
+		initHiresTimer(&gCmdRecordTimer);
+		initThreadSystem(&pThreadSystem);
         // FILE PATHS
 		fsSetPathForResourceDir(pSystemFileIO, RM_CONTENT, RD_SHADER_BINARIES, "CompiledShaders");
 		fsSetPathForResourceDir(pSystemFileIO, RM_CONTENT, RD_GPU_CONFIG,      "GPUCfg");
@@ -355,12 +1207,47 @@ class ImposterRendering: public IApp
 		fsSetPathForResourceDir(pSystemFileIO, RM_CONTENT, RD_FONTS,           "Fonts");
 		fsSetPathForResourceDir(pSystemFileIO, RM_CONTENT, RD_ANIMATIONS,      "Animation");
 		fsSetPathForResourceDir(pSystemFileIO, RM_CONTENT, RD_SCRIPTS,		   "Scripts");
+		fsSetPathForResourceDir(pSystemFileIO, RM_CONTENT, RD_OTHER_FILES,     "Imposters");
+
+		//Headless bake: capture every frame and view, write the atlas file and quit.
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--bake-imposters") == 0)
+				gImposterBakeAndExit = gImposterBakeRequested = true;
+		}
+
+		uint32_t archetypeVariantCount = 0;
+		for (int i = 1; i + 1 < argc; ++i)
+		{
+			if (strcmp(argv[i], "--archetype-variants") == 0)
+				archetypeVariantCount = (uint32_t)atoi(argv[i + 1]);
+		}
+		RegisterImposterArchetypes(archetypeVariantCount);
+
+		//Pick the live archetype, one headless bake writes every archetype's file.
+		for (int i = 1; i + 1 < argc; ++i)
+		{
+			if (strcmp(argv[i], "--archetype") != 0)
+				continue;
+
+			bool found = false;
+			for (uint32_t a = 0; a < gImposterArchetypeCount && !found; ++a)
+			{
+				found = strcmp(argv[i + 1], gImposterArchetypeDescs[a].pName) == 0;
+				if (found)
+					gLiveArchetype = a;
+			}
+
+			if (!found)
+				LOGF(eERROR, "Unknown archetype %s, keeping %s", argv[i + 1], gImposterArchetypeDescs[gLiveArchetype].pName);
+		}
 
 		//Init all resources, setups.
 		Initialize();
 		
 		// PROFILER SETUP
 		gGpuProfileToken = addGpuProfiler(renderer, queue, "Graphics");
+		gComputeProfileToken = addGpuProfiler(renderer, pComputeQueue, "Compute");
 
 		// UI SETUP
 		vec2    UIPosition = { mSettings.mWidth * 0.01f, mSettings.mHeight * 0.15f };
@@ -420,6 +1307,56 @@ class ImposterRendering: public IApp
 				GENERAL_PARAM_SEPARATOR_9,
 				GENERAL_PARAM_IMPOSTER_COUNT_RESET,
 				GENERAL_PARAM_SEPARATOR_10,
+				GENERAL_PARAM_PRE_SKIN_COMPUTE,
+				GENERAL_PARAM_SEPARATOR_11,
+				GENERAL_PARAM_SINGLE_PASS_CAPTURE,
+				GENERAL_PARAM_SEPARATOR_12,
+				GENERAL_PARAM_CAPTURE_VIEWS_PER_FRAME,
+				GENERAL_PARAM_SEPARATOR_13,
+				GENERAL_PARAM_USE_BAKED_IMPOSTERS,
+				GENERAL_PARAM_SEPARATOR_14,
+				GENERAL_PARAM_BAKE_IMPOSTERS,
+				GENERAL_PARAM_SEPARATOR_15,
+				GENERAL_PARAM_PHASE_SPREAD,
+				GENERAL_PARAM_SEPARATOR_16,
+				GENERAL_PARAM_VIEW_LAYOUT,
+				GENERAL_PARAM_SEPARATOR_17,
+				GENERAL_PARAM_BLEND_VIEWS,
+				GENERAL_PARAM_SEPARATOR_18,
+				GENERAL_PARAM_COMPACTED_DRAWS,
+				GENERAL_PARAM_SEPARATOR_19,
+				GENERAL_PARAM_OCCLUSION_CULLING,
+				GENERAL_PARAM_SEPARATOR_20,
+				GENERAL_PARAM_CLUSTER_CULLING,
+				GENERAL_PARAM_SEPARATOR_21,
+				GENERAL_PARAM_NEAR_FIELD_SKINNING,
+				GENERAL_PARAM_SEPARATOR_22,
+				GENERAL_PARAM_NEAR_FIELD_COUNT,
+				GENERAL_PARAM_SEPARATOR_23,
+				GENERAL_PARAM_NEAR_FIELD_DISTANCE,
+				GENERAL_PARAM_SEPARATOR_24,
+				GENERAL_PARAM_CROWD_ANIM_COUNT,
+				GENERAL_PARAM_SEPARATOR_25,
+				GENERAL_PARAM_USE_POSE_CACHE,
+				GENERAL_PARAM_SEPARATOR_26,
+				GENERAL_PARAM_POSE_CACHE_SAMPLE_RATE,
+				GENERAL_PARAM_SEPARATOR_27,
+				GENERAL_PARAM_VAT_MID_FIELD,
+				GENERAL_PARAM_SEPARATOR_28,
+				GENERAL_PARAM_VAT_DISTANCE,
+				GENERAL_PARAM_SEPARATOR_29,
+				GENERAL_PARAM_BONE_PALETTE_FORMAT,
+				GENERAL_PARAM_SEPARATOR_30,
+				GENERAL_PARAM_CAPTURE_TICK_RATE,
+				GENERAL_PARAM_SEPARATOR_31,
+				GENERAL_PARAM_ASYNC_COMPUTE,
+				GENERAL_PARAM_SEPARATOR_32,
+				GENERAL_PARAM_PARALLEL_RECORDING,
+				GENERAL_PARAM_SEPARATOR_33,
+				GENERAL_PARAM_FRAMES_IN_FLIGHT,
+				GENERAL_PARAM_SEPARATOR_34,
+				GENERAL_PARAM_LATE_LATCH_CAMERA,
+				GENERAL_PARAM_SEPARATOR_35,
 
 				GENERAL_PARAM_COUNT
 			};
@@ -593,10 +1530,207 @@ class ImposterRendering: public IApp
 			widgets[GENERAL_PARAM_IMPOSTER_COUNT_RESET]->pWidget = &resetImposter;
 			uiSetWidgetOnActiveCallback(widgets[GENERAL_PARAM_IMPOSTER_COUNT_RESET], nullptr, ResetImposterCountCallback);
 
+			CheckboxWidget preSkinCompute;
+			preSkinCompute.pData = &gUIData.mGeneralSettings.mPreSkinCompute;
+			widgets[GENERAL_PARAM_PRE_SKIN_COMPUTE]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_PRE_SKIN_COMPUTE]->mLabel, "Compute Pre-Skinning");
+			widgets[GENERAL_PARAM_PRE_SKIN_COMPUTE]->pWidget = &preSkinCompute;
+
+			CheckboxWidget singlePassCapture;
+			singlePassCapture.pData = &gUIData.mGeneralSettings.mSinglePassCapture;
+			widgets[GENERAL_PARAM_SINGLE_PASS_CAPTURE]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_SINGLE_PASS_CAPTURE]->mLabel, "Single Pass Capture");
+			widgets[GENERAL_PARAM_SINGLE_PASS_CAPTURE]->pWidget = &singlePassCapture;
+
+			SliderIntWidget captureViewsPerFrame;
+			captureViewsPerFrame.pData = &gUIData.mGeneralSettings.captureViewsPerFrame;
+			captureViewsPerFrame.mMin = 1;
+			captureViewsPerFrame.mMax = TextureCount;
+			captureViewsPerFrame.mStep = 1;
+
+			widgets[GENERAL_PARAM_CAPTURE_VIEWS_PER_FRAME]->mType = WIDGET_TYPE_SLIDER_INT;
+			strcpy(widgets[GENERAL_PARAM_CAPTURE_VIEWS_PER_FRAME]->mLabel, "Capture Views Per Frame");
+			widgets[GENERAL_PARAM_CAPTURE_VIEWS_PER_FRAME]->pWidget = &captureViewsPerFrame;
+
+			CheckboxWidget useBakedImposters;
+			useBakedImposters.pData = &gUIData.mGeneralSettings.mUseBakedImposters;
+			widgets[GENERAL_PARAM_USE_BAKED_IMPOSTERS]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_USE_BAKED_IMPOSTERS]->mLabel, "Use Baked Imposters");
+			widgets[GENERAL_PARAM_USE_BAKED_IMPOSTERS]->pWidget = &useBakedImposters;
+
+			CheckboxWidget bakeImposters;
+			bakeImposters.pData = NULL;
+			widgets[GENERAL_PARAM_BAKE_IMPOSTERS]->mType = WIDGET_TYPE_BUTTON;
+			strcpy(widgets[GENERAL_PARAM_BAKE_IMPOSTERS]->mLabel, "Bake Imposters");
+			widgets[GENERAL_PARAM_BAKE_IMPOSTERS]->pWidget = &bakeImposters;
+			uiSetWidgetOnActiveCallback(widgets[GENERAL_PARAM_BAKE_IMPOSTERS], nullptr, BakeImpostersCallback);
+
+			SliderFloatWidget phaseSpread;
+			phaseSpread.pData = &gUIData.mGeneralSettings.phaseSpread;
+			phaseSpread.mMin = 0.f;
+			phaseSpread.mMax = 1.f;
+			phaseSpread.mStep = 0.01f;
+			widgets[GENERAL_PARAM_PHASE_SPREAD]->mType = WIDGET_TYPE_SLIDER_FLOAT;
+			strcpy(widgets[GENERAL_PARAM_PHASE_SPREAD]->mLabel, "Animation Phase Spread");
+			widgets[GENERAL_PARAM_PHASE_SPREAD]->pWidget = &phaseSpread;
+
+			DropdownWidget viewLayout;
+			viewLayout.pData = &gUIData.mGeneralSettings.viewLayout;
+			viewLayout.pNames = gImposterViewLayoutNames;
+			viewLayout.mCount = IMPOSTER_VIEW_LAYOUT_COUNT;
+			widgets[GENERAL_PARAM_VIEW_LAYOUT]->mType = WIDGET_TYPE_DROPDOWN;
+			strcpy(widgets[GENERAL_PARAM_VIEW_LAYOUT]->mLabel, "Imposter View Layout");
+			widgets[GENERAL_PARAM_VIEW_LAYOUT]->pWidget = &viewLayout;
+
+			CheckboxWidget blendViews;
+			blendViews.pData = &gUIData.mGeneralSettings.mBlendViews;
+			widgets[GENERAL_PARAM_BLEND_VIEWS]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_BLEND_VIEWS]->mLabel, "Blend Nearest Views");
+			widgets[GENERAL_PARAM_BLEND_VIEWS]->pWidget = &blendViews;
+
+			CheckboxWidget compactedDraws;
+			compactedDraws.pData = &gUIData.mGeneralSettings.mCompactedDraws;
+			widgets[GENERAL_PARAM_COMPACTED_DRAWS]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_COMPACTED_DRAWS]->mLabel, "GPU Compacted Draws");
+			widgets[GENERAL_PARAM_COMPACTED_DRAWS]->pWidget = &compactedDraws;
+
+			CheckboxWidget occlusionCulling;
+			occlusionCulling.pData = &gUIData.mGeneralSettings.mOcclusionCulling;
+			widgets[GENERAL_PARAM_OCCLUSION_CULLING]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_OCCLUSION_CULLING]->mLabel, "HiZ Occlusion Culling");
+			widgets[GENERAL_PARAM_OCCLUSION_CULLING]->pWidget = &occlusionCulling;
+
+			CheckboxWidget clusterCulling;
+			clusterCulling.pData = &gUIData.mGeneralSettings.mClusterCulling;
+			widgets[GENERAL_PARAM_CLUSTER_CULLING]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_CLUSTER_CULLING]->mLabel, "Cluster Culling");
+			widgets[GENERAL_PARAM_CLUSTER_CULLING]->pWidget = &clusterCulling;
+
+			CheckboxWidget nearFieldSkinning;
+			nearFieldSkinning.pData = &gUIData.mGeneralSettings.mNearFieldSkinning;
+			widgets[GENERAL_PARAM_NEAR_FIELD_SKINNING]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_NEAR_FIELD_SKINNING]->mLabel, "Near Field Skinned Meshes");
+			widgets[GENERAL_PARAM_NEAR_FIELD_SKINNING]->pWidget = &nearFieldSkinning;
+
+			SliderIntWidget nearFieldCount;
+			nearFieldCount.pData = &gUIData.mGeneralSettings.nearFieldCount;
+			nearFieldCount.mMin = 1;
+			nearFieldCount.mMax = MaxNearFieldCount;
+			nearFieldCount.mStep = 1;
+			widgets[GENERAL_PARAM_NEAR_FIELD_COUNT]->mType = WIDGET_TYPE_SLIDER_INT;
+			strcpy(widgets[GENERAL_PARAM_NEAR_FIELD_COUNT]->mLabel, "Near Field Max Count");
+			widgets[GENERAL_PARAM_NEAR_FIELD_COUNT]->pWidget = &nearFieldCount;
+
+			SliderFloatWidget nearFieldDistance;
+			nearFieldDistance.pData = &gUIData.mGeneralSettings.nearFieldDistance;
+			nearFieldDistance.mMin = 1.f;
+			nearFieldDistance.mMax = 50.f;
+			nearFieldDistance.mStep = 0.5f;
+			widgets[GENERAL_PARAM_NEAR_FIELD_DISTANCE]->mType = WIDGET_TYPE_SLIDER_FLOAT;
+			strcpy(widgets[GENERAL_PARAM_NEAR_FIELD_DISTANCE]->mLabel, "Near Field Distance");
+			widgets[GENERAL_PARAM_NEAR_FIELD_DISTANCE]->pWidget = &nearFieldDistance;
+
+			SliderIntWidget crowdAnimCount;
+			crowdAnimCount.pData = &gUIData.mGeneralSettings.crowdAnimCount;
+			crowdAnimCount.mMin = 0;
+			crowdAnimCount.mMax = MaxCrowdAnimCount;
+			crowdAnimCount.mStep = 1;
+			widgets[GENERAL_PARAM_CROWD_ANIM_COUNT]->mType = WIDGET_TYPE_SLIDER_INT;
+			strcpy(widgets[GENERAL_PARAM_CROWD_ANIM_COUNT]->mLabel, "CPU Crowd Animations");
+			widgets[GENERAL_PARAM_CROWD_ANIM_COUNT]->pWidget = &crowdAnimCount;
+
+			CheckboxWidget usePoseCache;
+			usePoseCache.pData = &gUIData.mGeneralSettings.mUsePoseCache;
+			widgets[GENERAL_PARAM_USE_POSE_CACHE]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_USE_POSE_CACHE]->mLabel, "Pre-Sampled Pose Cache");
+			widgets[GENERAL_PARAM_USE_POSE_CACHE]->pWidget = &usePoseCache;
+
+			SliderIntWidget poseCacheSampleRate;
+			poseCacheSampleRate.pData = &gUIData.mGeneralSettings.poseCacheSampleRate;
+			poseCacheSampleRate.mMin = 5;
+			poseCacheSampleRate.mMax = 120;
+			poseCacheSampleRate.mStep = 1;
+			widgets[GENERAL_PARAM_POSE_CACHE_SAMPLE_RATE]->mType = WIDGET_TYPE_SLIDER_INT;
+			strcpy(widgets[GENERAL_PARAM_POSE_CACHE_SAMPLE_RATE]->mLabel, "Pose Cache Sample Rate");
+			widgets[GENERAL_PARAM_POSE_CACHE_SAMPLE_RATE]->pWidget = &poseCacheSampleRate;
+			uiSetWidgetOnDeactivatedAfterEditCallback(widgets[GENERAL_PARAM_POSE_CACHE_SAMPLE_RATE], nullptr, PoseCacheSampleRateCallback);
+
+			CheckboxWidget vatMidField;
+			vatMidField.pData = &gUIData.mGeneralSettings.mVatMidField;
+			widgets[GENERAL_PARAM_VAT_MID_FIELD]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_VAT_MID_FIELD]->mLabel, "Vertex Animation Mid Field");
+			widgets[GENERAL_PARAM_VAT_MID_FIELD]->pWidget = &vatMidField;
+
+			SliderFloatWidget vatDistance;
+			vatDistance.pData = &gUIData.mGeneralSettings.vatDistance;
+			vatDistance.mMin = 5.f;
+			vatDistance.mMax = 150.f;
+			vatDistance.mStep = 1.f;
+			widgets[GENERAL_PARAM_VAT_DISTANCE]->mType = WIDGET_TYPE_SLIDER_FLOAT;
+			strcpy(widgets[GENERAL_PARAM_VAT_DISTANCE]->mLabel, "Vertex Animation Distance");
+			widgets[GENERAL_PARAM_VAT_DISTANCE]->pWidget = &vatDistance;
+
+			DropdownWidget bonePaletteFormat;
+			bonePaletteFormat.pData = &gUIData.mGeneralSettings.bonePaletteFormat;
+			bonePaletteFormat.pNames = gBonePaletteFormatNames;
+			bonePaletteFormat.mCount = BONE_PALETTE_FORMAT_COUNT;
+			widgets[GENERAL_PARAM_BONE_PALETTE_FORMAT]->mType = WIDGET_TYPE_DROPDOWN;
+			strcpy(widgets[GENERAL_PARAM_BONE_PALETTE_FORMAT]->mLabel, "Bone Palette Format");
+			widgets[GENERAL_PARAM_BONE_PALETTE_FORMAT]->pWidget = &bonePaletteFormat;
+
+			SliderIntWidget captureTickRate;
+			captureTickRate.pData = &gUIData.mGeneralSettings.captureTickRate;
+			captureTickRate.mMin = 0;
+			captureTickRate.mMax = 60;
+			captureTickRate.mStep = 1;
+			widgets[GENERAL_PARAM_CAPTURE_TICK_RATE]->mType = WIDGET_TYPE_SLIDER_INT;
+			strcpy(widgets[GENERAL_PARAM_CAPTURE_TICK_RATE]->mLabel, "Capture Tick Rate (0 = Display)");
+			widgets[GENERAL_PARAM_CAPTURE_TICK_RATE]->pWidget = &captureTickRate;
+
+			CheckboxWidget asyncCompute;
+			asyncCompute.pData = &gUIData.mGeneralSettings.mAsyncCompute;
+			widgets[GENERAL_PARAM_ASYNC_COMPUTE]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_ASYNC_COMPUTE]->mLabel, "Async Compute Queue");
+			widgets[GENERAL_PARAM_ASYNC_COMPUTE]->pWidget = &asyncCompute;
+
+			CheckboxWidget parallelRecording;
+			parallelRecording.pData = &gUIData.mGeneralSettings.mParallelRecording;
+			widgets[GENERAL_PARAM_PARALLEL_RECORDING]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_PARALLEL_RECORDING]->mLabel, "Parallel Cmd Recording");
+			widgets[GENERAL_PARAM_PARALLEL_RECORDING]->pWidget = &parallelRecording;
+
+			SliderIntWidget framesInFlight;
+			framesInFlight.pData = &gUIData.mGeneralSettings.framesInFlight;
+			framesInFlight.mMin = 1;
+			framesInFlight.mMax = MaxDataBufferCount;
+			framesInFlight.mStep = 1;
+			widgets[GENERAL_PARAM_FRAMES_IN_FLIGHT]->mType = WIDGET_TYPE_SLIDER_INT;
+			strcpy(widgets[GENERAL_PARAM_FRAMES_IN_FLIGHT]->mLabel, "Frames In Flight");
+			widgets[GENERAL_PARAM_FRAMES_IN_FLIGHT]->pWidget = &framesInFlight;
+
+			CheckboxWidget lateLatchCamera;
+			lateLatchCamera.pData = &gUIData.mGeneralSettings.mLateLatchCamera;
+			widgets[GENERAL_PARAM_LATE_LATCH_CAMERA]->mType = WIDGET_TYPE_CHECKBOX;
+			strcpy(widgets[GENERAL_PARAM_LATE_LATCH_CAMERA]->mLabel, "Late Latch Camera");
+			widgets[GENERAL_PARAM_LATE_LATCH_CAMERA]->pWidget = &lateLatchCamera;
+
 			luaRegisterWidget(uiCreateComponentWidget(pStandaloneControlsGUIWindow, "General Settings", &collapsingGeneralSettingsWidgets, WIDGET_TYPE_COLLAPSING_HEADER));
 		}
 
 		waitForAllResourceLoads();
+		SetLiveArchetype(gLiveArchetype);
+
+		//Needs the loaded vertex count and joint remaps.
+		InitSkinnedVertexResource();
+		InitBonePaletteResource();
+		BuildPoseCache((uint32_t)gUIData.mGeneralSettings.poseCacheSampleRate);
+		InitNearFieldResource();
+		InitVatResource();
+
+		//Stream a previously baked atlas, baking stays opt-in through --bake-imposters or the UI button.
+		if (!gImposterBakeAndExit && LoadImposterBakes())
+			gUIData.mGeneralSettings.mUseBakedImposters = true;
+		waitForAllResourceLoads();
 
 		InputSystemDesc inputDesc = {};
 		inputDesc.pRenderer = renderer;
@@ -679,33 +1813,86 @@ class ImposterRendering: public IApp
 		exitFontSystem();
 
 		//Exit all resources.
-		removeResource(pGeomData);
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+		{
+			removeResource(gImposterArchetypes[i].pGeomData);
+			removeResource(gImposterArchetypes[i].pGeom);
+			removeResource(gImposterArchetypes[i].pDiffuse);
+		}
 		pGeomData = nullptr;
-		removeResource(pGeom);
 		pGeom = nullptr;
+		pTextureDiffuse = nullptr;
 
 		//Remove all buffer resources.
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
-			removeResource(pBufferBoneTransformations[i]->buffer);
-			removeResource(pBufferQuadTransformations[i]->buffer);
 			removeResource(pBufferJointModelMats[i]->buffer);
 			removeResource(pBufferJointWorldMats[i]->buffer);
 			removeResource(pBufferJointScales[i]->buffer);
 			removeResource(pBufferBoneWorldMats[i]->buffer);
-			removeResource(pBufferPlaneTransformations[i]->buffer);
 			removeResource(pBufferQuadAngles[i]->buffer);
+			removeResource(pBufferSkinnedVertices[i]->buffer);
+			removeResource(pBufferAngleBinReadback[i]->buffer);
+			removeResource(pBufferCaptureViewList[i]->buffer);
+			removeResource(pBufferVisibleIndices[i]->buffer);
+			removeResource(pBufferQuadIndirectArgs[i]->buffer);
+			removeResource(pBufferShadowIndices[i]->buffer);
+			removeResource(pBufferShadowIndirectArgs[i]->buffer);
+			removeResource(pBufferOcclusionCandidates[i]->buffer);
+			removeResource(pBufferRetestIndices[i]->buffer);
+			removeResource(pBufferRetestIndirectArgs[i]->buffer);
+			removeResource(pBufferRetestDispatchArgs[i]->buffer);
+			removeResource(pBufferOcclusionCounters[i]->buffer);
+			removeResource(pBufferOcclusionReadback[i]->buffer);
+			removeResource(pBufferVisibleClusters[i]->buffer);
+			removeResource(pBufferBonePalette[i]->buffer);
+			removeResource(pBufferJointWorldMatsReadback[i]->buffer);
+			removeResource(pBufferClusterDispatchArgs[i]->buffer);
+			removeResource(pBufferNearFieldIndices[i]->buffer);
+			removeResource(pBufferNearFieldArgs[i]->buffer);
+			removeResource(pBufferNearFieldPalettes[i]->buffer);
+			removeResource(pBufferNearFieldHistogram[i]->buffer);
+			removeResource(pBufferCrowdPalettes[i]->buffer);
+			removeResource(pBufferVatIndices[i]->buffer);
+			removeResource(pBufferVatArgs[i]->buffer);
 			
-			tf_free(pBufferBoneTransformations[i]);
-			tf_free(pBufferQuadTransformations[i]);
 			tf_free(pBufferJointModelMats[i]);
 			tf_free(pBufferJointWorldMats[i]);
 			tf_free(pBufferJointScales[i]);
 			tf_free(pBufferBoneWorldMats[i]);
-			tf_free(pBufferPlaneTransformations[i]);
 			tf_free(pBufferQuadAngles[i]);
+			tf_free(pBufferSkinnedVertices[i]);
+			tf_free(pBufferAngleBinReadback[i]);
+			tf_free(pBufferCaptureViewList[i]);
+			tf_free(pBufferVisibleIndices[i]);
+			tf_free(pBufferQuadIndirectArgs[i]);
+			tf_free(pBufferShadowIndices[i]);
+			tf_free(pBufferShadowIndirectArgs[i]);
+			tf_free(pBufferOcclusionCandidates[i]);
+			tf_free(pBufferRetestIndices[i]);
+			tf_free(pBufferRetestIndirectArgs[i]);
+			tf_free(pBufferRetestDispatchArgs[i]);
+			tf_free(pBufferOcclusionCounters[i]);
+			tf_free(pBufferOcclusionReadback[i]);
+			tf_free(pBufferVisibleClusters[i]);
+			tf_free(pBufferBonePalette[i]);
+			tf_free(pBufferJointWorldMatsReadback[i]);
+			tf_free(pBufferClusterDispatchArgs[i]);
+			tf_free(pBufferNearFieldIndices[i]);
+			tf_free(pBufferNearFieldArgs[i]);
+			tf_free(pBufferNearFieldPalettes[i]);
+			tf_free(pBufferNearFieldHistogram[i]);
+			tf_free(pBufferCrowdPalettes[i]);
+			tf_free(pBufferVatIndices[i]);
+			tf_free(pBufferVatArgs[i]);
+		}
+		RemoveImposterAtlas(&gImposterAtlas);
+
+		for (uint32_t i = 0; i < MaxImposterArchetypes; ++i)
+		{
+			if (pImposterBakeTextures[i])
+				removeResource(pImposterBakeTextures[i]);
 		}
-		removeResource(pTextureDiffuse);
 
 		removeResource(pBufferPlaneVertex->buffer);
 		tf_free(pBufferPlaneVertex);
@@ -713,6 +1900,12 @@ class ImposterRendering: public IApp
 		removeResource(pBufferJointParentsIndex->buffer);
 		tf_free(pBufferJointParentsIndex);
 
+		removeResource(pBufferJointLevelOrder->buffer);
+		tf_free(pBufferJointLevelOrder);
+
+		removeResource(pBufferJointLevelRanges->buffer);
+		tf_free(pBufferJointLevelRanges);
+
 		removeResource(pBufferQuadVertex->buffer);
 		tf_free(pBufferQuadVertex);
 
@@ -721,12 +1914,62 @@ class ImposterRendering: public IApp
 
 		removeResource(pBufferQuadsPosition->buffer);
 		tf_free(pBufferQuadsPosition);
+		removeResource(pBufferQuadPhases->buffer);
+		tf_free(pBufferQuadPhases);
+		removeResource(pBufferQuadArchetypes->buffer);
+		tf_free(pBufferQuadArchetypes);
+
+		removeResource(pBufferImposterViewMats->buffer);
+		tf_free(pBufferImposterViewMats);
+
+		removeResource(pBufferImposterHeapLayouts->buffer);
+		tf_free(pBufferImposterHeapLayouts);
+
+		removeResource(pBufferAngleBinUsage->buffer);
+		tf_free(pBufferAngleBinUsage);
+
+		removeResource(pBufferQuadIndirectArgsReset->buffer);
+		tf_free(pBufferQuadIndirectArgsReset);
+
+		removeResource(pBufferOcclusionCountersReset->buffer);
+		tf_free(pBufferOcclusionCountersReset);
+
+		removeResource(pBufferLatencyReadback->buffer);
+		tf_free(pBufferLatencyReadback);
+
+		removeResource(pBufferImposterClusters->buffer);
+		tf_free(pBufferImposterClusters);
+
+		removeResource(pBufferJointRemaps->buffer);
+		tf_free(pBufferJointRemaps);
+
+		removeResource(pBufferInverseBindPoses->buffer);
+		tf_free(pBufferInverseBindPoses);
+
+		RemovePoseCache();
+		tf_free(pBufferPoseRotations);
+		tf_free(pBufferPoseTranslations);
+		tf_free(pBufferPoseScales);
+
+		removeResource(pBufferNearFieldArgsReset->buffer);
+		tf_free(pBufferNearFieldArgsReset);
+
+		removeResource(pBufferNearFieldHistogramReset->buffer);
+		tf_free(pBufferNearFieldHistogramReset);
+
+		removeResource(pBufferVertexAnimation->buffer);
+		tf_free(pBufferVertexAnimation);
+
+		removeResource(pBufferVatArgsReset->buffer);
+		tf_free(pBufferVatArgsReset);
+
+		removeResource(pBufferClusterDispatchArgsReset->buffer);
+		tf_free(pBufferClusterDispatchArgsReset);
 
 		removeResource(pBufferShadowTransformations->buffer);
 		tf_free(pBufferShadowTransformations);
 
-		removeResource(pBufferFrustumPlanes->buffer);
-		tf_free(pBufferFrustumPlanes);
+		removeResource(gUploadRing.pBuffer);
 
 		//Exit camera controllers.
 		exitCameraController(billboardCamera);
@@ -739,26 +1982,48 @@ class ImposterRendering: public IApp
 		removeSampler(renderer, pShadowSampler);
 
 		removeSemaphore(renderer, pImageAcquiredSemaphore);
-		removeGpuCmdRing(renderer, gGraphicsCmdRing);
+		removeSemaphore(renderer, pHiZBuiltSemaphore);
+		removeQueryPool(renderer, pLatencyQueryPool);
+		removeCmd(renderer, pBakeCmd);
+		removeCmdPool(renderer, pBakeCmdPool);
+		removeFence(renderer, pBakeFence);
+		RemoveCmdRings();
 
 		exitResourceLoaderInterface(renderer);
 		removeQueue(renderer, queue);
+		removeQueue(renderer, pComputeQueue);
 
 		tf_delete(gGraphicsCmdRing);
+		tf_delete(gComputeCmdRing);
 		exitRenderer(renderer);
 		renderer = NULL;
 
 		//Exit all animation datas.
-		gStickFigureRig->Exit();
-		gClip->Exit();
-		gAnimation->Exit();
-		gStickFigureAnimObject->Exit();
+		waitThreadSystemIdle(pThreadSystem);
+		exitThreadSystem(pThreadSystem);
+		for (uint32_t i = 0; i < MaxCrowdAnimCount; ++i)
+		{
+			gCrowdAnims[i].pAnimObject->Exit();
+			gCrowdAnims[i].pAnimation->Exit();
+			tf_delete(gCrowdAnims[i].pAnimObject);
+			tf_delete(gCrowdAnims[i].pAnimation);
+			tf_delete(gCrowdAnims[i].pClipController);
+		}
 
-		tf_delete(gStickFigureRig);
-		tf_delete(gClip);
-		tf_delete(gClipController);
-		tf_delete(gStickFigureAnimObject);
-		tf_delete(gAnimation);
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+		{
+			ImposterArchetype& archetype = gImposterArchetypes[i];
+			archetype.pRig->Exit();
+			archetype.pClip->Exit();
+			archetype.pAnimation->Exit();
+			archetype.pAnimObject->Exit();
+
+			tf_delete(archetype.pRig);
+			tf_delete(archetype.pClip);
+			tf_delete(archetype.pClipController);
+			tf_delete(archetype.pAnimObject);
+			tf_delete(archetype.pAnimation);
+		}
 	}
 
 	bool Load(ReloadDesc* pReloadDesc)
@@ -809,6 +2074,7 @@ class ImposterRendering: public IApp
 	void Unload(ReloadDesc* pReloadDesc)
 	{
 		waitQueueIdle(queue);
+		waitQueueIdle(pComputeQueue);
 		unloadFontSystem(pReloadDesc->mType);
 		unloadUserInterface(pReloadDesc->mType);
 
@@ -835,12 +2101,20 @@ class ImposterRendering: public IApp
 	}
 
 	void Update(float deltaTime)
+	{
+		dtSave = deltaTime;
+
+		//Late latched, Draw samples the camera once the frame's fence has been waited on.
+		if (!gUIData.mGeneralSettings.mLateLatchCamera)
+			UpdateCamera(deltaTime);
+	}
+
+	void UpdateCamera(float deltaTime)
 	{
 		/************************************************************************/
 		// Input Update
 		/************************************************************************/
-
-		dtSave = deltaTime;
+		gInputSampleTime = getUSec(false);
 		updateInputSystem(deltaTime, mSettings.mWidth, mSettings.mHeight);
 
 		if(gUIData.mGeneralSettings.mUsingMainCam)
@@ -889,6 +2163,54 @@ class ImposterRendering: public IApp
 			::toggleVSync(renderer, &pSwapChain);
 		}
 		
+		if (AsyncComputeActive() != gAsyncComputeLastFrame)
+			ApplyAsyncCompute(AsyncComputeActive());
+
+		if ((uint32_t)gUIData.mGeneralSettings.framesInFlight != gDataBufferCount)
+			ApplyFramesInFlight((uint32_t)gUIData.mGeneralSettings.framesInFlight);
+
+		if (gUIData.mGeneralSettings.viewLayout != gImposterViewLayout)
+			ApplyImposterViewLayout(gUIData.mGeneralSettings.viewLayout);
+
+		if (gUIData.mGeneralSettings.bonePaletteFormat == BONE_PALETTE_FORMAT_DUAL_QUAT && gRigHasScale)
+		{
+			LOGF(eWARNING, "%s has scaled joints, dual quaternion palettes are rigid only, keeping 3x4 rows", gImposterArchetypeDescs[gLiveArchetype].pName);
+			gUIData.mGeneralSettings.bonePaletteFormat = BONE_PALETTE_FORMAT_MAT3X4;
+		}
+
+		//Shaders are picked per palette format, the reload switches CPU packing and shaders together.
+		if (gUIData.mGeneralSettings.bonePaletteFormat != gBonePaletteFormat && !gBonePaletteReloadRequested)
+		{
+			gBonePaletteReloadRequested = true;
+			ReloadDesc reloadDesc = { RELOAD_TYPE_SHADER };
+			requestReload(&reloadDesc);
+		}
+
+		if (gPoseCacheRebuildRequested)
+		{
+			gPoseCacheRebuildRequested = false;
+			if ((uint32_t)gUIData.mGeneralSettings.poseCacheSampleRate != gPoseCache.mSampleRate)
+				ApplyPoseCacheSampleRate((uint32_t)gUIData.mGeneralSettings.poseCacheSampleRate);
+		}
+
+		if (gVatBakeRequested)
+		{
+			gVatBakeRequested = false;
+			BakeVertexAnimation();
+		}
+
+		if (gImposterBakeRequested)
+		{
+			gImposterBakeRequested = false;
+			BakeImposters();
+
+			if (gImposterBakeAndExit)
+			{
+				requestShutdown();
+				return;
+			}
+		}
+
 		uint32_t swapchainImageIndex;
 		acquireNextImage(renderer, pSwapChain, pImageAcquiredSemaphore, NULL, &swapchainImageIndex);
 
@@ -898,56 +2220,121 @@ class ImposterRendering: public IApp
 		if (fenceStatus == FENCE_STATUS_INCOMPLETE)
 			waitForFences(renderer, 1, &elem.pFence);
 
+		const bool asyncCompute = AsyncComputeActive();
+		GpuCmdRingElement computeElem = {};
+		if (asyncCompute)
+		{
+			computeElem = getNextGpuCmdRingElement(gComputeCmdRing, true, 1);
+			getFenceStatus(renderer, computeElem.pFence, &fenceStatus);
+			if (fenceStatus == FENCE_STATUS_INCOMPLETE)
+				waitForFences(renderer, 1, &computeElem.pFence);
+		}
+
+		//Both slots are free, a late latched camera is sampled only now and uploaded right after.
+		PollFrameLatency();
+		if (gUIData.mGeneralSettings.mLateLatchCamera)
+			UpdateCamera(dtSave);
+		gFrameLatency[gFrameIndex] = { elem.pFence, gInputSampleTime };
+
+		//This frame's readback slot is safe to read now.
+		gCaptureTick = AdvanceCaptureTick();
+		if (gCaptureTick)
+			ScheduleImposterCapture();
+		if (gOcclusionReadbackReady[gFrameIndex])
+			pBufferOcclusionReadback[gFrameIndex]->ReadData(gOcclusionCounters);
+		//Accelerator pose from gDataBufferCount frames ago, for CPU side users of the rig.
+		if (gJointWorldMatsReadbackReady[gFrameIndex] && GpuAnimationPalette())
+			pBufferJointWorldMatsReadback[gFrameIndex]->ReadData(gStickFigureAnimObject->mJointWorldMats.begin());
+
 		/************************************************************************/
 		// Cmds
 		/************************************************************************/
 
+		//One pool per list so the workers never share one, the first list's fence guards the whole frame.
+		Cmd* frameCmds[RECORD_LIST_COUNT] = {};
 		resetCmdPool(renderer, elem.pCmdPool);
+		frameCmds[RECORD_LIST_PROLOGUE] = elem.pCmds[0];
+		for (uint32_t i = RECORD_LIST_PROLOGUE + 1; i < RECORD_LIST_COUNT; ++i)
+		{
+			GpuCmdRingElement listElem = getNextGpuCmdRingElement(gGraphicsCmdRing, true, 1);
+			resetCmdPool(renderer, listElem.pCmdPool);
+			frameCmds[i] = listElem.pCmds[0];
+		}
 
-		Cmd* cmd = elem.pCmds[0];
-		beginCmd(cmd);    // start recording commands
+		Cmd* prologueCmd = frameCmds[RECORD_LIST_PROLOGUE];
+		beginCmd(prologueCmd);    // start recording commands
 		
 		// start gpu frame profiler
-		cmdBeginGpuFrameProfile(cmd, gGpuProfileToken);
+		cmdBeginGpuFrameProfile(prologueCmd, gGpuProfileToken);
 
 		/************************************************************************/
 		// Anim Datas
 		/************************************************************************/
-		UpdateAnims(cmd, &gGpuProfileToken);
-
-		pBufferPlaneTransformations[gFrameIndex]->UpdateData(&projViewModelMatrices);
-		pBufferBoneTransformations[gFrameIndex]->UpdateData(&gUniformDataBones);
-		pBufferQuadTransformations[gFrameIndex]->UpdateData(&projViewModelMatrices);
+		Cmd* computeCmd = prologueCmd;
+		ProfileToken computeToken = gGpuProfileToken;
+		if (asyncCompute)
+		{
+			resetCmdPool(renderer, computeElem.pCmdPool);
+			computeCmd = computeElem.pCmds[0];
+			computeToken = gComputeProfileToken;
+			beginCmd(computeCmd);
+			cmdBeginGpuFrameProfile(computeCmd, gComputeProfileToken);
+		}
+		//Culling reads last frame's pyramid on the compute queue, then gives it back for this frame's build.
+		const bool hizOnCompute = asyncCompute && gHiZBuiltSemaphorePending;
+		if (hizOnCompute)
+			TransferHiZOwnership(computeCmd, false, QUEUE_TYPE_GRAPHICS);
 
-		//Angle Compute btw camera & billboards.
-		DispatchAngleCompute(cmd);
+		UpdateAnims(computeCmd, &computeToken);
 
-		RenderTargetBarrier rtsBarrier[TextureCount] = {};
-		RenderTargetBarrier shadowDepthBarrier = {};
+		WriteUpload(gUploadCamera, &projViewModelMatrices, sizeof(projViewModelMatrices));
 
-		//Change rts state to render target for capturing.
-		for(int i = 0; i < TextureCount; ++i)
-			rtsBarrier[i] = {rts[i], RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_RENDER_TARGET};
-		cmdResourceBarrier(cmd, 0, NULL, 0, NULL, TextureCount, rtsBarrier);
+		//Angle Compute btw camera & billboards.
+		DispatchAngleCompute(computeCmd, computeToken);
+		CopyAngleBinUsage(computeCmd);
+		DispatchNearFieldPalettes(computeCmd, computeToken);
 
-		shadowDepthBarrier = {shadowDepthRT, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_DEPTH_WRITE};
-		cmdResourceBarrier(cmd, 0, NULL, 0, NULL, 1, &shadowDepthBarrier);
+		//Pose the mesh once for every capture view, the main draw alone skins in the vertex shader.
+		gPosedMeshReady = gUIData.mGeneralSettings.mPreSkinCompute && gCaptureTick && !UsingBakedImposters();
+		if (gPosedMeshReady)
+			DispatchSkinningCompute(computeCmd, computeToken);
 
-		//Capture to rendertarget of skinning anims.
-		CaptureToRT(cmd);
+		if (asyncCompute)
+		{
+			if (hizOnCompute)
+				TransferHiZOwnership(computeCmd, true, QUEUE_TYPE_GRAPHICS);
+			SubmitAsyncCompute(computeCmd, computeElem);
+			TransferAsyncComputeOwnership(prologueCmd, false);
+			if (hizOnCompute)
+				TransferHiZOwnership(prologueCmd, false, QUEUE_TYPE_COMPUTE);
+		}
+		endCmd(prologueCmd);
 
-		//Change rts state to shader resource for using as texture.
-		for(int i = 0; i < TextureCount; ++i)
-			rtsBarrier[i] = {rts[i], RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_SHADER_RESOURCE};
-		cmdResourceBarrier(cmd, 0, NULL, 0, NULL, TextureCount, rtsBarrier);
+		//Passes and barriers are settled before any list is recorded, the workers only read the graph.
+		DeclareFrameGraph(pSwapChain->ppRenderTargets[swapchainImageIndex]);
+		CompileFrameGraph();
 
-		//Store depth values of the scene.
-		FillShadowDepthRT(cmd);
+		//Capture and shadow depend on nothing recorded after the prologue, workers record them while this thread records the main pass.
+		//The GPU profiler is not thread safe, worker recorded passes go without timestamps.
+		resetHiresTimer(&gCmdRecordTimer);
+		const bool parallelRecording = gUIData.mGeneralSettings.mParallelRecording;
+		if (parallelRecording)
+		{
+			gPassRecordTaskData.pApp = this;
+			gPassRecordTaskData.ppCmds = frameCmds;
+			addThreadSystemRangeTask(pThreadSystem, RecordPassTask, &gPassRecordTaskData, RECORD_LIST_MAIN - RECORD_LIST_CAPTURE);
+		}
+		else
+		{
+			RecordCapturePass(frameCmds[RECORD_LIST_CAPTURE], true);
+			RecordShadowPass(frameCmds[RECORD_LIST_SHADOW], true);
+		}
 
-		shadowDepthBarrier = {shadowDepthRT, RESOURCE_STATE_DEPTH_WRITE, RESOURCE_STATE_SHADER_RESOURCE};
-		cmdResourceBarrier(cmd, 0, NULL, 0, NULL, 1, &shadowDepthBarrier);
+		Cmd* cmd = frameCmds[RECORD_LIST_MAIN];
+		beginCmd(cmd);
 
 		//Back to the default render target.
+		CmdFrameGraphBarriers(cmd, FRAME_GRAPH_PASS_MAIN);
 		BindDefaultRT(cmd, swapchainImageIndex);
 
 		/************************************************************************/
@@ -955,14 +2342,54 @@ class ImposterRendering: public IApp
 		/************************************************************************/
 		RenderPlane(cmd);
 
-		RenderQuads(cmd);
+		RenderQuads(cmd, 0);
 
 		RenderAnimation(cmd);
 
-		/************************************************************************/
-		// Render UIs
-		/************************************************************************/
-		cmdBeginDebugMarker(cmd, 0, 1, 0, "Draw UI");
+		RenderNearField(cmd);
+
+		RenderVatMeshes(cmd);
+
+		//Occlusion phase two, pyramid from this frame's depth also serves next frame's phase one.
+		if (OcclusionCullingActive())
+		{
+			cmdBindRenderTargets(cmd, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
+			BuildHiZ(cmd);
+			RetestOccludedImposters(cmd);
+			if (asyncCompute)
+				TransferHiZOwnership(cmd, true, QUEUE_TYPE_COMPUTE);
+		}
+
+		//The rest goes to its own list, next frame's compute only waits for the lists up to the pyramid.
+		endCmd(cmd);
+		cmd = frameCmds[RECORD_LIST_OVERLAY];
+		beginCmd(cmd);
+
+		if (OcclusionCullingActive())
+		{
+			LoadActionsDesc resumeLoadActions = {};
+			resumeLoadActions.mLoadActionsColor[0] = LOAD_ACTION_LOAD;
+			resumeLoadActions.mLoadActionDepth = LOAD_ACTION_LOAD;
+			RenderTarget* pSceneTarget = pSwapChain->ppRenderTargets[swapchainImageIndex];
+			cmdBindRenderTargets(cmd, 1, &pSceneTarget, pDepthBuffer, &resumeLoadActions, NULL, NULL, -1, -1);
+			cmdSetViewport(cmd, 0.f, 0.f, (float)pSceneTarget->mWidth, (float)pSceneTarget->mHeight, 0.f, 1.f);
+			cmdSetScissor(cmd, 0, 0, pSceneTarget->mWidth, pSceneTarget->mHeight);
+			RenderQuads(cmd, 1);
+
+			gHiZViewProj = viewProjMatMainCamera.getPrimaryMatrix();
+			gHiZValid = true;
+		}
+		else
+		{
+			gHiZValid = false;
+		}
+		cmdBindRenderTargets(cmd, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
+		CopyOcclusionCounters(cmd);
+
+		/************************************************************************/
+		// Render UIs
+		/************************************************************************/
+		cmdBeginDebugMarker(cmd, 0, 1, 0, "Draw UI");
 		LoadActionsDesc loadActions = {};
 		RenderTarget* pRenderTarget = pSwapChain->ppRenderTargets[swapchainImageIndex];
 		loadActions.mLoadActionsColor[0] = LOAD_ACTION_LOAD;
@@ -998,29 +2425,94 @@ class ImposterRendering: public IApp
 		gFrameTimeDraw.pText = debugUIText;
 		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y + 135.f), &gFrameTimeDraw);
 
-		cmdDrawGpuProfile(cmd, float2(8.f, txtSize.y * 2.f + 160.f), gGpuProfileToken, &gFrameTimeDraw);
+		//Scheduler counters go to the profiler, the capture budget is tuned against their history.
+		MICROPROFILE_COUNTER_SET("Imposters/Capture/Refreshed Views", gCaptureScheduler.mRefreshCount);
+		MICROPROFILE_COUNTER_SET("Imposters/Capture/Visible Staleness", gCaptureScheduler.mMaxVisibleStaleness);
+		MICROPROFILE_COUNTER_SET("Imposters/Capture/Staleness", gCaptureScheduler.mMaxStaleness);
+
+		//Counters are integers, the culled fraction is kept in per mille.
+		const uint32_t tested = gOcclusionCounters[OCCLUSION_COUNTER_TESTED];
+		const uint32_t occluded = gOcclusionCounters[OCCLUSION_COUNTER_CANDIDATES] - gOcclusionCounters[OCCLUSION_COUNTER_RECOVERED];
+		MICROPROFILE_COUNTER_SET("Imposters/Occlusion/Culled Per Mille", tested ? (uint64_t)occluded * 1000 / tested : 0);
+		MICROPROFILE_COUNTER_SET("Imposters/Occlusion/Recovered", gOcclusionCounters[OCCLUSION_COUNTER_RECOVERED]);
+
+		snprintf(debugUIText, 64, "Crowd Anim CPU : %u objects, %f ms", GpuAnimationPalette() ? 0u : gCrowdAnimTaskData.mCount, getHiresTimerUSecAverage(&gCrowdAnimTimer) / 1000.0f);
+		gFrameTimeDraw.pText = debugUIText;
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y + 155.f), &gFrameTimeDraw);
+
+		snprintf(debugUIText, 64, "Pose Cache : %u frames @ %u Hz, %.1f KB", gPoseCache.mFrameCount, gPoseCache.mSampleRate, (float)GetPoseCacheFootprint() / 1024.f);
+		gFrameTimeDraw.pText = debugUIText;
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y + 175.f), &gFrameTimeDraw);
+
+		snprintf(debugUIText, 64, "Bone Palette : %s, %u B", gBonePaletteFormatNames[gBonePaletteFormat], (uint32_t)BonePaletteSize());
+		gFrameTimeDraw.pText = debugUIText;
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y + 195.f), &gFrameTimeDraw);
+
+		snprintf(debugUIText, 64, "Cmd Recording : %f ms (%s)", getHiresTimerUSecAverage(&gCmdRecordTimer) / 1000.0f, parallelRecording ? "parallel" : "serial");
+		gFrameTimeDraw.pText = debugUIText;
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y + 215.f), &gFrameTimeDraw);
+
+		snprintf(debugUIText, 64, "Frame Graph : %u passes, %u culled, %u RT barriers", (uint32_t)FRAME_GRAPH_PASS_COUNT, gFrameGraph.mCulledCount, gFrameGraph.mBarrierCount);
+		gFrameTimeDraw.pText = debugUIText;
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y + 235.f), &gFrameTimeDraw);
+
+		//Latency is read off the GPU clock, it goes with the GPU profile rather than the CPU stats above.
+		const float2 gpuProfileSize = cmdDrawGpuProfile(cmd, float2(8.f, txtSize.y * 2.f + 320.f), gGpuProfileToken, &gFrameTimeDraw);
+		snprintf(debugUIText, 64, "Input To Frame End : %.1f ms, %u frames in flight%s", gInputLatencyMs, gDataBufferCount, gUIData.mGeneralSettings.mLateLatchCamera ? ", late latch" : "");
+		gFrameTimeDraw.pText = debugUIText;
+		cmdDrawTextWithFont(cmd, float2(8.f, txtSize.y * 2.f + 340.f + gpuProfileSize.y), &gFrameTimeDraw);
 
 		cmdDrawUserInterface(cmd);
 
 		cmdBindRenderTargets(cmd, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
 		cmdEndDebugMarker(cmd);
 
+		//Frame end on the GPU clock, resolved into this frame's slot for the latency readout.
+		QueryDesc latencyQuery = { gFrameIndex };
+		cmdResetQuery(cmd, pLatencyQueryPool, gFrameIndex, 1);
+		cmdEndQuery(cmd, pLatencyQueryPool, &latencyQuery);
+		cmdResolveQuery(cmd, pLatencyQueryPool, pBufferLatencyReadback->buffer, gFrameIndex, 1);
+
 
 		// PRESENT THE GRPAHICS QUEUE
-		RenderTargetBarrier barrier = {pRenderTarget, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PRESENT};
-		cmdResourceBarrier(cmd, 0, NULL, 0, NULL, 1, &barrier);
+		//The back buffer goes to present with the rest of the graph's resources.
+		CmdFrameGraphFinalBarriers(cmd);
 		cmdEndGpuFrameProfile(cmd, gGpuProfileToken);
 		endCmd(cmd);
 
+		if (parallelRecording)
+			waitThreadSystemIdle(pThreadSystem);
+		getHiresTimerUSec(&gCmdRecordTimer, true);
+
+		//Graphics waits on this frame's compute, next frame's compute waits on the HiZ built here.
+		Semaphore* waitSemaphores[2] = { pImageAcquiredSemaphore, computeElem.pSemaphore };
+		const bool signalHiZ = asyncCompute && OcclusionCullingActive();
+		uint32_t firstList = RECORD_LIST_PROLOGUE;
+		if (signalHiZ)
+		{
+			//Lists up to the pyramid in their own submit, so its semaphore is not held back by the overlay.
+			QueueSubmitDesc hizSubmitDesc = {};
+			hizSubmitDesc.mCmdCount = RECORD_LIST_OVERLAY;
+			hizSubmitDesc.mSignalSemaphoreCount = 1;
+			hizSubmitDesc.mWaitSemaphoreCount = 2;
+			hizSubmitDesc.ppCmds = frameCmds;
+			hizSubmitDesc.ppSignalSemaphores = &pHiZBuiltSemaphore;
+			hizSubmitDesc.ppWaitSemaphores = waitSemaphores;
+			queueSubmit(queue, &hizSubmitDesc);
+			firstList = RECORD_LIST_OVERLAY;
+		}
+
+		//The fence of the last submit covers the whole frame, the queue completes in order.
 		QueueSubmitDesc submitDesc = {};
-		submitDesc.mCmdCount = 1;
+		submitDesc.mCmdCount = RECORD_LIST_COUNT - firstList;
 		submitDesc.mSignalSemaphoreCount = 1;
-		submitDesc.mWaitSemaphoreCount = 1;
-		submitDesc.ppCmds = &cmd;
+		submitDesc.mWaitSemaphoreCount = signalHiZ ? 0 : (asyncCompute ? 2 : 1);
+		submitDesc.ppCmds = frameCmds + firstList;
 		submitDesc.ppSignalSemaphores = &elem.pSemaphore;
-		submitDesc.ppWaitSemaphores = &pImageAcquiredSemaphore;
+		submitDesc.ppWaitSemaphores = waitSemaphores;
 		submitDesc.pSignalFence = elem.pFence;
 		queueSubmit(queue, &submitDesc);
+		gHiZBuiltSemaphorePending = signalHiZ;
 		QueuePresentDesc presentDesc = {};
 		presentDesc.mIndex = swapchainImageIndex;
 		presentDesc.mWaitSemaphoreCount = 1;
@@ -1036,43 +2528,152 @@ class ImposterRendering: public IApp
 	////////////////////////////////////////////////////////////////////////////////////
 	//										Init Funcs								  //
 	////////////////////////////////////////////////////////////////////////////////////
+	bool QueryMultiViewCaptureSupport()
+	{
+		//Layer select outside the geometry shader is optional on D3D12 and an extension on Vulkan, D3D11 has neither.
+#if defined(DIRECT3D12)
+#if defined(USE_MULTIPLE_RENDER_APIS)
+		if (gSelectedRendererApi == RENDERER_API_D3D12)
+#endif
+		{
+			D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+			if (FAILED(renderer->mDx.pDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))))
+				return false;
+			return options.VPAndRTArrayIndexFromAnyShaderFeedingRasterizerSupportedWithoutGSEmulation == TRUE;
+		}
+#endif
+#if defined(VULKAN)
+#if defined(USE_MULTIPLE_RENDER_APIS)
+		if (gSelectedRendererApi == RENDERER_API_VULKAN)
+#endif
+		{
+			return VkDeviceExtensionSupported(VK_EXT_SHADER_VIEWPORT_INDEX_LAYER_EXTENSION_NAME);
+		}
+#endif
+		return false;
+	}
+
+#if defined(VULKAN)
+	bool VkDeviceExtensionSupported(const char* pExtensionName)
+	{
+		uint32_t extensionCount = 0;
+		vkEnumerateDeviceExtensionProperties(renderer->pGpu->mVk.pGpu, NULL, &extensionCount, NULL);
+		VkExtensionProperties* pExtensions = (VkExtensionProperties*)tf_malloc(sizeof(VkExtensionProperties) * extensionCount);
+		vkEnumerateDeviceExtensionProperties(renderer->pGpu->mVk.pGpu, NULL, &extensionCount, pExtensions);
+
+		bool supported = false;
+		for (uint32_t i = 0; i < extensionCount && !supported; ++i)
+			supported = strcmp(pExtensions[i].extensionName, pExtensionName) == 0;
+
+		tf_free(pExtensions);
+		return supported;
+	}
+
+	VkTimeDomainEXT GetHostTimeDomain()
+	{
+		//The clock getUSec reads.
+#if defined(_WINDOWS)
+		return VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+		return VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+	}
+#endif
+
+	bool QueryGpuClockCalibrationSupport()
+	{
+		//D3D12 queues always calibrate, Vulkan needs the extension with both the device and the host clock domain.
+#if defined(DIRECT3D12)
+#if defined(USE_MULTIPLE_RENDER_APIS)
+		if (gSelectedRendererApi == RENDERER_API_D3D12)
+#endif
+		{
+			return true;
+		}
+#endif
+#if defined(VULKAN)
+#if defined(USE_MULTIPLE_RENDER_APIS)
+		if (gSelectedRendererApi == RENDERER_API_VULKAN)
+#endif
+		{
+			if (!VkDeviceExtensionSupported(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+				return false;
+
+			uint32_t domainCount = 0;
+			vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(renderer->pGpu->mVk.pGpu, &domainCount, NULL);
+			VkTimeDomainEXT* pDomains = (VkTimeDomainEXT*)tf_malloc(sizeof(VkTimeDomainEXT) * domainCount);
+			vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(renderer->pGpu->mVk.pGpu, &domainCount, pDomains);
+
+			bool device = false;
+			bool host = false;
+			for (uint32_t i = 0; i < domainCount; ++i)
+			{
+				device = device || pDomains[i] == VK_TIME_DOMAIN_DEVICE_EXT;
+				host = host || pDomains[i] == GetHostTimeDomain();
+			}
+
+			tf_free(pDomains);
+			return device && host;
+		}
+#endif
+		return false;
+	}
+
 	void Initialize()
 	{
-		gStickFigureRig = tf_new(Rig);
-		gClip = tf_new(Clip);
-		gClipController = tf_new(ClipController);
-		gStickFigureAnimObject = tf_new(AnimatedObject);
-		gAnimation = tf_new(Animation);
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+		{
+			ImposterArchetype& archetype = gImposterArchetypes[i];
+			const ImposterArchetypeDesc& archetypeDesc = gImposterArchetypeDescs[i];
+			archetype.pRig = tf_new(Rig);
+			archetype.pClip = tf_new(Clip);
+			archetype.pClipController = tf_new(ClipController);
+			archetype.pAnimObject = tf_new(AnimatedObject);
+			archetype.pAnimation = tf_new(Animation);
+
+			//Initialize the rig with the path to its ozz file.
+			archetype.pRig->Initialize(RD_ANIMATIONS, archetypeDesc.pSkeletonFile);
 
-		//Initialize the rig with the path to its ozz file.
-		gStickFigureRig->Initialize(RD_ANIMATIONS, gStickFigureName);
+			//Clip initialize.
+			archetype.pClip->Initialize(RD_ANIMATIONS, archetypeDesc.pClipFile, archetype.pRig);
 
-		//Clip initialize.
-		gClip->Initialize(RD_ANIMATIONS, gClipName, gStickFigureRig);
+			ASSERT(MAX_NUM_BONES >= archetype.pRig->mNumJoints);
 
-		ASSERT(MAX_NUM_BONES >= gStickFigureRig->mNumJoints);
+			//Clip controller initialize.
+			//Initialize with the length of the clip they are controlling and an
+			//optional external time to set based on their updating.
+			archetype.pClipController->Initialize(archetype.pClip->GetDuration(), &gUIData.mClip.mAnimationTime);
 
-		//Clip controller initialize.
-		//Initialize with the length of the clip they are controlling and an
-		//optional external time to set based on their updating.
-		gClipController->Initialize(gClip->GetDuration(), &gUIData.mClip.mAnimationTime);
+			//Anim initialization.
+			AnimationDesc animationDesc{};
 
-		//Anim initialization.
-		AnimationDesc animationDesc{};
+			animationDesc.mRig = archetype.pRig;
+			animationDesc.mNumLayers = 1;
+			animationDesc.mLayerProperties[0].mClip = archetype.pClip;
+			animationDesc.mLayerProperties[0].mClipController = archetype.pClipController;
 
-		animationDesc.mRig = gStickFigureRig;
-		animationDesc.mNumLayers = 1;
-		animationDesc.mLayerProperties[0].mClip = gClip;
-		animationDesc.mLayerProperties[0].mClipController = gClipController;
+			archetype.pAnimation->Initialize(animationDesc);
+			archetype.pAnimObject->Initialize(archetype.pRig, archetype.pAnimation);
+		}
+		SetLiveArchetype(gLiveArchetype);
 
-		gAnimation->Initialize(animationDesc);
-		gStickFigureAnimObject->Initialize(gStickFigureRig, gAnimation);
+		InitCrowdAnims();
 
 		//Setting Renderer
 		RendererDesc setting = {};
 		setting.mD3D11Supported = true;
+#if defined(VULKAN)
+		//Layered capture and clock calibration need their extensions enabled, each is skipped when the device does not expose it.
+		const char* pDeviceExtensions[] = { VK_EXT_SHADER_VIEWPORT_INDEX_LAYER_EXTENSION_NAME, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME };
+		setting.mVk.ppDeviceExtensions = pDeviceExtensions;
+		setting.mVk.mDeviceExtensionCount = TF_ARRAY_COUNT(pDeviceExtensions);
+#endif
 		initRenderer(GetName(), &setting, &renderer);
 
+		gMultiViewCaptureSupported = QueryMultiViewCaptureSupport();
+		if (!gMultiViewCaptureSupported)
+			LOGF(eWARNING, "No render target array index from the vertex shader, single pass capture falls back to one draw per view");
+
 		//Setting Queue
 		QueueDesc queueDesc{};
 
@@ -1081,19 +2682,39 @@ class ImposterRendering: public IApp
 
 		addQueue(renderer, &queueDesc, &queue);
 
-		//Setting cmdRing
-		gGraphicsCmdRing = tf_new(GpuCmdRing);
-
-		GpuCmdRingDesc cmdRingDesc;
-		cmdRingDesc.pQueue = queue;
-		cmdRingDesc.mPoolCount = gDataBufferCount;
-		cmdRingDesc.mCmdPerPoolCount = 1;
-		cmdRingDesc.mAddSyncPrimitives = true;
+		//Compute queue, falls back to the graphics family without a dedicated one.
+		queueDesc.mType = QUEUE_TYPE_COMPUTE;
+		addQueue(renderer, &queueDesc, &pComputeQueue);
 
-		addGpuCmdRing(renderer, &cmdRingDesc, gGraphicsCmdRing);
+		//Setting cmdRings
+		gDataBufferCount = (uint32_t)gUIData.mGeneralSettings.framesInFlight;
+		gGraphicsCmdRing = tf_new(GpuCmdRing);
+		gComputeCmdRing = tf_new(GpuCmdRing);
+		AddCmdRings();
 
 		//Semaphore
 		addSemaphore(renderer, &pImageAcquiredSemaphore);
+		addSemaphore(renderer, &pHiZBuiltSemaphore);
+
+		//Latency timestamps
+		QueryPoolDesc latencyQueryPoolDesc{};
+		latencyQueryPoolDesc.mType = QUERY_TYPE_TIMESTAMP;
+		latencyQueryPoolDesc.mQueryCount = MaxDataBufferCount;
+		addQueryPool(renderer, &latencyQueryPoolDesc, &pLatencyQueryPool);
+		getTimestampFrequency(queue, &gGpuTimestampFrequency);
+		gGpuClockCalibrationSupported = QueryGpuClockCalibrationSupport();
+		if (!gGpuClockCalibrationSupported)
+			LOGF(eWARNING, "No GPU clock calibration, input latency is measured up to the frame fence instead of the frame end timestamp");
+
+		//Bake cmd
+		CmdPoolDesc bakeCmdPoolDesc{};
+		bakeCmdPoolDesc.pQueue = queue;
+		addCmdPool(renderer, &bakeCmdPoolDesc, &pBakeCmdPool);
+
+		CmdDesc bakeCmdDesc{};
+		bakeCmdDesc.pPool = pBakeCmdPool;
+		addCmd(renderer, &bakeCmdDesc, &pBakeCmd);
+		addFence(renderer, &pBakeFence);
 
 		initResourceLoaderInterface(renderer);
 
@@ -1149,11 +2770,13 @@ class ImposterRendering: public IApp
 		//Setting Texture
 		TextureLoadDesc diffuseTextureDesc{};
 
-		diffuseTextureDesc.pFileName = gDiffuseTexture;
-		diffuseTextureDesc.ppTexture = &pTextureDiffuse;
 		diffuseTextureDesc.mCreationFlag = TEXTURE_CREATION_FLAG_SRGB;
-
-		addResource(&diffuseTextureDesc, NULL);
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+		{
+			diffuseTextureDesc.pFileName = gImposterArchetypeDescs[i].pDiffuseTexture;
+			diffuseTextureDesc.ppTexture = &gImposterArchetypes[i].pDiffuse;
+			addResource(&diffuseTextureDesc, NULL);
+		}
 
 		//Setting shadow proj mat.
 		float3 minRange = gUIData.mClip.mOrthographicShadowRangeMin;
@@ -1175,10 +2798,81 @@ class ImposterRendering: public IApp
 		//Cameras
 		InitCameraControllers();
 
+		//Needs the capture matrices.
+		InitImposterViewResource();
+
 		//GeomLoad
 		InitGeometryLoad();
 	}
 
+	void RegisterImposterArchetypes(uint32_t variantCount)
+	{
+		//A variant reuses a shipped row's assets under its own name and bake file, so a crowd of several archetypes
+		//can be run, baked and streamed with the art that ships.
+		gImposterArchetypeCount = 0;
+		for (uint32_t i = 0; i < gShippedArchetypeCount; ++i)
+			gImposterArchetypeDescs[gImposterArchetypeCount++] = gShippedArchetypeDescs[i];
+
+		for (uint32_t v = 0; v < variantCount && gImposterArchetypeCount < MaxImposterArchetypes; ++v)
+		{
+			const ImposterArchetypeDesc& source = gShippedArchetypeDescs[v % gShippedArchetypeCount];
+			char* pName = gArchetypeVariantNames[gImposterArchetypeCount];
+			char* pBakeFile = gArchetypeVariantBakeFiles[gImposterArchetypeCount];
+			snprintf(pName, sizeof(gArchetypeVariantNames[0]), "%s_%u", source.pName, v + 1);
+			snprintf(pBakeFile, sizeof(gArchetypeVariantBakeFiles[0]), "%s_%u.imposter", source.pName, v + 1);
+
+			ImposterArchetypeDesc& variant = gImposterArchetypeDescs[gImposterArchetypeCount++];
+			variant = source;
+			variant.pName = pName;
+			variant.pBakeFile = pBakeFile;
+		}
+
+		if (gImposterArchetypeCount < gShippedArchetypeCount + variantCount)
+			LOGF(eWARNING, "Registry holds %u archetypes, dropped %u variants", MaxImposterArchetypes, gShippedArchetypeCount + variantCount - gImposterArchetypeCount);
+	}
+
+	void InitCrowdAnims()
+	{
+		//Rig and clip are shared read-only, every crowd member owns its controller, animation and pose.
+		for (uint32_t i = 0; i < MaxCrowdAnimCount; ++i)
+		{
+			CrowdAnim& crowdAnim = gCrowdAnims[i];
+			crowdAnim.pClipController = tf_new(ClipController);
+			crowdAnim.pAnimation = tf_new(Animation);
+			crowdAnim.pAnimObject = tf_new(AnimatedObject);
+		}
+		BindCrowdAnims(false);
+	}
+
+	void BindCrowdAnims(bool rebind)
+	{
+		//Every crowd member animates the live archetype's rig and clip.
+		const float clipDuration = gClip->GetDuration();
+		for (uint32_t i = 0; i < MaxCrowdAnimCount; ++i)
+		{
+			CrowdAnim& crowdAnim = gCrowdAnims[i];
+			if (rebind)
+			{
+				crowdAnim.pAnimObject->Exit();
+				crowdAnim.pAnimation->Exit();
+			}
+
+			crowdAnim.pClipController->Initialize(clipDuration, &crowdAnim.mAnimationTime);
+			//Golden ratio phases keep any prefix of the crowd spread over the clip.
+			const float phase = fmodf((float)i * 0.618034f, 1.f);
+			crowdAnim.pClipController->SetTimeRatioHard(phase * clipDuration);
+
+			AnimationDesc animationDesc{};
+			animationDesc.mRig = gStickFigureRig;
+			animationDesc.mNumLayers = 1;
+			animationDesc.mLayerProperties[0].mClip = gClip;
+			animationDesc.mLayerProperties[0].mClipController = crowdAnim.pClipController;
+
+			crowdAnim.pAnimation->Initialize(animationDesc);
+			crowdAnim.pAnimObject->Initialize(gStickFigureRig, crowdAnim.pAnimation);
+		}
+	}
+
 	void InitGeometryLoad()
 	{
 		VertexLayout gVertexLayoutSkinned{};
@@ -1211,13 +2905,105 @@ class ImposterRendering: public IApp
 		gVertexLayoutSkinned.mAttribs[4].mOffset = 12 * sizeof(float);
 
 		GeometryLoadDesc loadDesc{};
-		loadDesc.pFileName = "stormtrooper/riggedMesh.bin";
 		loadDesc.pVertexLayout = &gVertexLayoutSkinned;
-		loadDesc.ppGeometry = &pGeom;
-		loadDesc.ppGeometryData = &pGeomData;
-		loadDesc.mFlags = GEOMETRY_LOAD_FLAG_SHADOWED;
+		loadDesc.mFlags = GEOMETRY_LOAD_FLAG_SHADOWED | GEOMETRY_LOAD_FLAG_STRUCTURED_BUFFERS;
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+		{
+			loadDesc.pFileName = gImposterArchetypeDescs[i].pMeshFile;
+			loadDesc.ppGeometry = &gImposterArchetypes[i].pGeom;
+			loadDesc.ppGeometryData = &gImposterArchetypes[i].pGeomData;
+			addResource(&loadDesc, NULL);
+		}
+	}
+
+	void SetLiveArchetype(uint32_t archetype)
+	{
+		//CPU side only, geometry pointers are filled once their loads finished.
+		const ImposterArchetype& assets = gImposterArchetypes[archetype];
+		gLiveArchetype = archetype;
+		gStickFigureRig = assets.pRig;
+		gClip = assets.pClip;
+		gClipController = assets.pClipController;
+		gAnimation = assets.pAnimation;
+		gStickFigureAnimObject = assets.pAnimObject;
+		pGeom = assets.pGeom;
+		pGeomData = assets.pGeomData;
+		pTextureDiffuse = assets.pDiffuse;
+	}
+
+	void SwitchLiveArchetype(uint32_t archetype)
+	{
+		//Repoint the live assets and everything uploaded or bound from them, buffers are sized for the largest archetype.
+		if (archetype == gLiveArchetype)
+			return;
+
+		waitThreadSystemIdle(pThreadSystem);
+		DrainQueues();
+		SetLiveArchetype(archetype);
+		UploadArchetypeSkinData();
+		BindCrowdAnims(true);
+
+		//Built from the rig and clip, the hierarchy depth and clip length differ per archetype.
+		const uint32_t sampleRate = gPoseCache.mSampleRate;
+		RemoveJointLevels();
+		InitJointLevels();
+		RemovePoseCache();
+		BuildPoseCache(sampleRate);
+
+		//Draw args carry the live index count, the mid field waits for a rebake of the live mesh.
+		IndirectDrawIndexArguments resetArgs = { pGeom->mIndexCount, 0, 0, 0, 0 };
+		pBufferNearFieldArgsReset->UpdateData(&resetArgs);
+		pBufferVatArgsReset->UpdateData(&resetArgs);
+		gVatBakeRequested = true;
+
+		waitForAllResourceLoads();
+		PrepareDescriptorSets();
+	}
+
+	uint32_t GetMaxArchetypeVertexCount()
+	{
+		uint32_t vertexCount = 0;
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+			vertexCount = max(vertexCount, gImposterArchetypes[i].pGeom->mVertexCount);
+		return vertexCount;
+	}
+
+	uint32_t GetMaxArchetypeJointCount()
+	{
+		uint32_t jointCount = 0;
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+			jointCount = max(jointCount, gImposterArchetypes[i].pGeomData->mJointCount);
+		return jointCount;
+	}
+
+	uint32_t GetMaxArchetypeRigJointCount()
+	{
+		uint32_t jointCount = 0;
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+			jointCount = max(jointCount, gImposterArchetypes[i].pRig->mNumJoints);
+		return jointCount;
+	}
 
-		addResource(&loadDesc, NULL);
+	void AddCmdRings()
+	{
+		//Sized for gDataBufferCount, a frame's fence only guards its slot if the rings cycle with gFrameIndex.
+		GpuCmdRingDesc cmdRingDesc;
+		cmdRingDesc.pQueue = queue;
+		//One pool per command list of a frame, each recording thread owns its pool.
+		cmdRingDesc.mPoolCount = gDataBufferCount * RECORD_LIST_COUNT;
+		cmdRingDesc.mCmdPerPoolCount = 1;
+		cmdRingDesc.mAddSyncPrimitives = true;
+		addGpuCmdRing(renderer, &cmdRingDesc, gGraphicsCmdRing);
+
+		cmdRingDesc.pQueue = pComputeQueue;
+		cmdRingDesc.mPoolCount = gDataBufferCount;
+		addGpuCmdRing(renderer, &cmdRingDesc, gComputeCmdRing);
+	}
+
+	void RemoveCmdRings()
+	{
+		removeGpuCmdRing(renderer, gGraphicsCmdRing);
+		removeGpuCmdRing(renderer, gComputeCmdRing);
 	}
 
 	void InitResources()
@@ -1225,53 +3011,137 @@ class ImposterRendering: public IApp
 		//Populate buffers.
 		pBufferQuadVertex =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 		pBufferQuadsPosition =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferQuadPhases =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferQuadArchetypes =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 		pBufferQuadDirection =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 		pBufferPlaneVertex =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 		pBufferJointParentsIndex =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferJointLevelOrder =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferJointLevelRanges =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 		pBufferShadowTransformations = 	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
-		pBufferFrustumPlanes = 			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
-
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		pBufferImposterViewMats =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferImposterHeapLayouts =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferAngleBinUsage =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferQuadIndirectArgsReset =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferOcclusionCountersReset =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferLatencyReadback =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferImposterClusters =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferJointRemaps =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferInverseBindPoses =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferClusterDispatchArgsReset =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferPoseRotations =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferPoseTranslations =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferPoseScales =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferNearFieldArgsReset =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferNearFieldHistogramReset =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferVertexAnimation =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+		pBufferVatArgsReset =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
-			pBufferBoneTransformations[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
-			pBufferQuadTransformations[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 			pBufferQuadAngles[i] =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
-			pBufferPlaneTransformations[i] =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 			pBufferJointScales[i] =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 			pBufferBoneWorldMats[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 			pBufferJointModelMats[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 			pBufferJointWorldMats[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferSkinnedVertices[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferAngleBinReadback[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferCaptureViewList[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferVisibleIndices[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferQuadIndirectArgs[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferShadowIndices[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferShadowIndirectArgs[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferOcclusionCandidates[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferRetestIndices[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferRetestIndirectArgs[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferRetestDispatchArgs[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferOcclusionCounters[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferOcclusionReadback[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferVisibleClusters[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferBonePalette[i] =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferJointWorldMatsReadback[i] =	(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferClusterDispatchArgs[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferNearFieldIndices[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferNearFieldArgs[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferNearFieldPalettes[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferNearFieldHistogram[i] =		(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferCrowdPalettes[i] =			(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferVatIndices[i] =				(MyBuffer*)tf_malloc(sizeof(MyBuffer));
+			pBufferVatArgs[i] =					(MyBuffer*)tf_malloc(sizeof(MyBuffer));
 		}
 
-		InitBoneResource();
+		InitUploadRing();
 		InitQuadResource();
 		InitImposterResource();
 		InitPlaneResource();
 		InitAnimAccelResource();
-		InitFrustumResource();
+		InitCaptureScheduleResource();
+		InitCompactionResource();
+		InitOcclusionResource();
+
+		AddImposterAtlas(&gImposterAtlasDesc, &gImposterAtlas);
 	}
 
-	void InitBoneResource()
+	UploadAllocation ReserveUpload(uint64_t size)
 	{
-		//Setting buffers
-		BufferLoadDesc boneUniformBufferDesc{};
+		//Linear, slots are never freed, the block only grows while resources are initialized.
+		UploadRing& ring = gUploadRing;
+		UploadAllocation allocation = { round_up_64(ring.mBlockSize, ring.mAlignment), size };
+		ring.mBlockSize = allocation.mOffset + size;
+		return allocation;
+	}
 
-		boneUniformBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		boneUniformBufferDesc.mDesc.mElementCount = 128;
-		boneUniformBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
-		boneUniformBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+	uint64_t GetUploadOffset(const UploadAllocation& allocation)
+	{
+		return gFrameIndex * gUploadRing.mBlockSize + allocation.mOffset;
+	}
 
-		boneUniformBufferDesc.mDesc.mStructStride = sizeof(mat4);
-		boneUniformBufferDesc.mDesc.mSize = boneUniformBufferDesc.mDesc.mStructStride * boneUniformBufferDesc.mDesc.mElementCount;
-		boneUniformBufferDesc.mDesc.pName = "PlaneUniformBuffer";
-		boneUniformBufferDesc.pData = NULL;
+	void* GetUploadData(const UploadAllocation& allocation)
+	{
+		//This frame's copy of the slot, safe to write once the frame fence has been waited on.
+		return gUploadRing.pMappedData + GetUploadOffset(allocation);
+	}
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
-		{
-			boneUniformBufferDesc.ppBuffer = &pBufferBoneTransformations[i]->buffer;
-			addResource(&boneUniformBufferDesc, NULL);
-			pBufferBoneTransformations[i]->size = boneUniformBufferDesc.mDesc.mSize;
-		}
+	void WriteUpload(const UploadAllocation& allocation, const void* source, uint64_t size)
+	{
+		ASSERT(size <= allocation.mSize);
+		memcpy(GetUploadData(allocation), source, size);
+	}
+
+	DescriptorDataRange GetUploadRange(const UploadAllocation& allocation, uint32_t frameIndex)
+	{
+		DescriptorDataRange range = {};
+		range.mOffset = (uint32_t)(frameIndex * gUploadRing.mBlockSize + allocation.mOffset);
+		range.mSize = (uint32_t)allocation.mSize;
+		return range;
+	}
+
+	void InitUploadRing()
+	{
+		//Slots are bound by offset, aligned for constant buffer views and copy sources alike.
+		UploadRing& ring = gUploadRing;
+		const uint64_t uniformAlignment = renderer->pGpu->mSettings.mUniformBufferAlignment;
+		ring.mAlignment = uniformAlignment > 256 ? uniformAlignment : 256;
+		ring.mBlockSize = 0;
+
+		gUploadCamera = ReserveUpload(sizeof(MatrixBlock));
+		gUploadFrustum = ReserveUpload(sizeof(FrustumBlock));
+		gUploadOcclusion = ReserveUpload(sizeof(OcclusionBlock));
+		gUploadVatBlock = ReserveUpload(sizeof(VatBlock));
+		gUploadBones = ReserveUpload(sizeof(UniformDataBones));
+		gUploadJointModelMats = ReserveUpload(GetMaxArchetypeRigJointCount() * sizeof(mat4));
+		ring.mBlockSize = round_up_64(ring.mBlockSize, ring.mAlignment);
+
+		BufferLoadDesc ringDesc{};
+		ringDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		ringDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		ringDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+		ringDesc.mDesc.mSize = ring.mBlockSize * MaxDataBufferCount;
+		ringDesc.mDesc.pName = "UploadRing";
+		ringDesc.pData = NULL;
+		ringDesc.ppBuffer = &ring.pBuffer;
+		addResource(&ringDesc, NULL);
+		ring.pMappedData = (uint8_t*)ring.pBuffer->pCpuMappedAddress;
 	}
 
 	void InitQuadResource()
@@ -1314,16 +3184,6 @@ class ImposterRendering: public IApp
 
 		addResource(&quadBufferDesc, NULL);
 		pBufferShadowTransformations->size = quadBufferDesc.mDesc.mSize;
-
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
-		{
-			quadBufferDesc.mDesc.pName = "QuadUniformBuffer";
-			quadBufferDesc.ppBuffer = &pBufferQuadTransformations[i]->buffer;
-			quadBufferDesc.pData = NULL;
-
-			addResource(&quadBufferDesc, NULL);
-			pBufferQuadTransformations[i]->size = quadBufferDesc.mDesc.mSize;
-		}
 	}
 
 	void InitImposterResource()
@@ -1332,38 +3192,62 @@ class ImposterRendering: public IApp
 		vec4* impPositions = (vec4*)tf_malloc(MaxImposterCount * sizeof(vec4));
 		vec4* impDirections = (vec4*)tf_malloc(MaxImposterCount * sizeof(vec4));
 		int* impCameraIndices = (int*)tf_malloc(MaxImposterCount * sizeof(int));
+		float* impPhases = (float*)tf_malloc(MaxImposterCount * sizeof(float));
+		uint32_t* impArchetypes = (uint32_t*)tf_malloc(MaxImposterCount * sizeof(uint32_t));
 
 		//Initializing datas.
 		for (int i = 0; i < MaxImposterCount; ++i)
 		{
 			impCameraIndices[i] = 0;
+			//Fraction of the clip each imposter runs ahead, keeps the crowd out of lockstep.
+			impPhases[i] = randomFloat01();
+			//Archetypes interleave so every cluster draws a mixed crowd.
+			impArchetypes[i] = (uint32_t)i % gImposterArchetypeCount;
 		}
 
-		vec4 position = { -100.f, .9f, -100.f, 1.f };
 		vec4 origin = { 0.f, 0.f, 0.f, 1.f };
 		int height = 100;
 		int width = 100;
 		int cd = MaxImposterCount / ImposterCountPerGroup;
 
+		//Same 100x100 grid per layer, stored cluster by cluster so each ImposterClusterDim^2 tile is contiguous.
+		ImposterCluster* impClusters = (ImposterCluster*)tf_malloc(MaxImposterClusterCount * sizeof(ImposterCluster));
+		const vec3 quadHalfExtent = { 2.f, 3.f, 2.f };
+		int index = 0;
+		int clusterIndex = 0;
+
 		for (int k = 0; k < cd; ++k)
 		{
-			for (int i = 0; i < height; ++i)
+			for (int ci = 0; ci < height / ImposterClusterDim; ++ci)
 			{
-				for (int j = 0; j < width; ++j)
+				for (int cj = 0; cj < width / ImposterClusterDim; ++cj)
 				{
-					int index = (k * width * height) + (i * width) + j;
-					impPositions[index] = position;
-					position += {0.f, 0.f, 2.f, 0.f};
-					vec4 dir = normalize(origin - impPositions[index]);
+					ImposterCluster& cluster = impClusters[clusterIndex++];
+					cluster.mFirstInstance = index;
+					cluster.mInstanceCount = ImposterClusterSize;
+					vec3 aabbMin = vec3(FLT_MAX);
+					vec3 aabbMax = vec3(-FLT_MAX);
+
+					for (int i = ci * ImposterClusterDim; i < (ci + 1) * ImposterClusterDim; ++i)
+					{
+						for (int j = cj * ImposterClusterDim; j < (cj + 1) * ImposterClusterDim; ++j)
+						{
+							vec4 position = { -100.f + 2.f * i, .9f + 3.5f * k, -100.f + 2.f * j, 1.f };
+							impPositions[index] = position;
+							impDirections[index] = normalize(origin - position);
+
+							aabbMin = minPerElem(aabbMin, position.getXYZ());
+							aabbMax = maxPerElem(aabbMax, position.getXYZ());
+							++index;
+						}
+					}
 
-					impDirections[index] = dir;
+					aabbMin -= quadHalfExtent;
+					aabbMax += quadHalfExtent;
+					cluster.mAabbMin = float4(aabbMin.getX(), aabbMin.getY(), aabbMin.getZ(), 1.f);
+					cluster.mAabbMax = float4(aabbMax.getX(), aabbMax.getY(), aabbMax.getZ(), 1.f);
 				}
-				position.setZ(-100.f);
-				position += {2.f, 0.f, 0.f, 0.f};
 			}
-			position.setX(-100.f);
-			position.setZ(-100.f);
-			position += {0.f, 3.5f, 0.f, 0.f};
 		}
 
 		//Setting buffers
@@ -1395,7 +3279,42 @@ class ImposterRendering: public IApp
 
 		tf_delete(impDirections);
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		imposterBuffersDescriptrion.mDesc.mStructStride = sizeof(float);
+		imposterBuffersDescriptrion.mDesc.mSize = imposterBuffersDescriptrion.mDesc.mStructStride * imposterBuffersDescriptrion.mDesc.mElementCount;
+		imposterBuffersDescriptrion.mDesc.pName = "ImposterPhase";
+		imposterBuffersDescriptrion.ppBuffer = &pBufferQuadPhases->buffer;
+		imposterBuffersDescriptrion.pData = impPhases;
+
+		addResource(&imposterBuffersDescriptrion, NULL);
+		pBufferQuadPhases->size = imposterBuffersDescriptrion.mDesc.mSize;
+
+		tf_delete(impPhases);
+
+		imposterBuffersDescriptrion.mDesc.mStructStride = sizeof(uint32_t);
+		imposterBuffersDescriptrion.mDesc.mSize = imposterBuffersDescriptrion.mDesc.mStructStride * imposterBuffersDescriptrion.mDesc.mElementCount;
+		imposterBuffersDescriptrion.mDesc.pName = "ImposterArchetype";
+		imposterBuffersDescriptrion.ppBuffer = &pBufferQuadArchetypes->buffer;
+		imposterBuffersDescriptrion.pData = impArchetypes;
+
+		addResource(&imposterBuffersDescriptrion, NULL);
+		pBufferQuadArchetypes->size = imposterBuffersDescriptrion.mDesc.mSize;
+
+		tf_delete(impArchetypes);
+
+		imposterBuffersDescriptrion.mDesc.mElementCount = MaxImposterClusterCount;
+		imposterBuffersDescriptrion.mDesc.mStructStride = sizeof(ImposterCluster);
+		imposterBuffersDescriptrion.mDesc.mSize = imposterBuffersDescriptrion.mDesc.mStructStride * imposterBuffersDescriptrion.mDesc.mElementCount;
+		imposterBuffersDescriptrion.mDesc.pName = "ImposterClusters";
+		imposterBuffersDescriptrion.ppBuffer = &pBufferImposterClusters->buffer;
+		imposterBuffersDescriptrion.pData = impClusters;
+
+		addResource(&imposterBuffersDescriptrion, NULL);
+		pBufferImposterClusters->size = imposterBuffersDescriptrion.mDesc.mSize;
+
+		tf_delete(impClusters);
+		imposterBuffersDescriptrion.mDesc.mElementCount = MaxImposterCount;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
 			imposterBuffersDescriptrion.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
 			imposterBuffersDescriptrion.mDesc.mStructStride = sizeof(int);
@@ -1435,49 +3354,34 @@ class ImposterRendering: public IApp
 
 		addResource(&planeVertexBufferDesc, NULL);
 		pBufferPlaneVertex->size = planeVertexBufferDesc.mDesc.mSize;
-
-		//Setting Uniform buffer
-		BufferLoadDesc planeUniformBufferDesc{};
-		planeUniformBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		planeUniformBufferDesc.mDesc.mElementCount = 1;
-		planeUniformBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
-		planeUniformBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
-
-		planeUniformBufferDesc.mDesc.mStructStride = sizeof(MatrixBlock);
-		planeUniformBufferDesc.mDesc.mSize = planeUniformBufferDesc.mDesc.mStructStride * planeUniformBufferDesc.mDesc.mElementCount;
-		planeUniformBufferDesc.mDesc.pName = "PlaneUniformBuffer";
-		planeUniformBufferDesc.pData = NULL;
-
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
-		{
-			planeUniformBufferDesc.ppBuffer = &pBufferPlaneTransformations[i]->buffer;
-			addResource(&planeUniformBufferDesc, NULL);
-			pBufferPlaneTransformations[i]->size = planeUniformBufferDesc.mDesc.mSize;
-		}
 	}
 
 	void InitAnimAccelResource()
 	{
 		BufferLoadDesc aaJointBufferDesc{};
 		aaJointBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
-		aaJointBufferDesc.mDesc.mElementCount = gStickFigureAnimObject->mRig->mNumJoints;
+		//Sized for the largest rig, UploadArchetypeSkinData fills in the live one's parents.
+		aaJointBufferDesc.mDesc.mElementCount = GetMaxArchetypeRigJointCount();
 		aaJointBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
 		aaJointBufferDesc.mDesc.mStructStride = sizeof(int);
 		aaJointBufferDesc.mDesc.mSize = aaJointBufferDesc.mDesc.mStructStride * aaJointBufferDesc.mDesc.mElementCount;
 		aaJointBufferDesc.mDesc.pName = "JointParentsSlots";
 		aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
-		aaJointBufferDesc.pData = gStickFigureAnimObject->mRig->mSkeleton.joint_parents().begin();
+		aaJointBufferDesc.pData = NULL;
 		aaJointBufferDesc.ppBuffer = &pBufferJointParentsIndex->buffer;
 		addResource(&aaJointBufferDesc, NULL);
 		pBufferJointParentsIndex->size = aaJointBufferDesc.mDesc.mSize;
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		InitJointLevels();
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
 			aaJointBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
 			aaJointBufferDesc.mDesc.mStructStride = sizeof(Vector3);
 			aaJointBufferDesc.mDesc.mSize = aaJointBufferDesc.mDesc.mStructStride * aaJointBufferDesc.mDesc.mElementCount;
 			aaJointBufferDesc.mDesc.pName = "JointScales";
-			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+			aaJointBufferDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
 			aaJointBufferDesc.pData = NULL;
 			aaJointBufferDesc.ppBuffer = &pBufferJointScales[i]->buffer;
 			addResource(&aaJointBufferDesc, NULL);
@@ -1486,7 +3390,7 @@ class ImposterRendering: public IApp
 			aaJointBufferDesc.mDesc.mStructStride = sizeof(mat4);
 			aaJointBufferDesc.mDesc.mSize = aaJointBufferDesc.mDesc.mStructStride * aaJointBufferDesc.mDesc.mElementCount;
 			aaJointBufferDesc.mDesc.pName = "BoneWorldMats";
-			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
 			aaJointBufferDesc.pData = NULL;
 			aaJointBufferDesc.ppBuffer = &pBufferBoneWorldMats[i]->buffer;
 			addResource(&aaJointBufferDesc, NULL);
@@ -1494,8 +3398,10 @@ class ImposterRendering: public IApp
 
 			aaJointBufferDesc.mDesc.mStructStride = sizeof(mat4);
 			aaJointBufferDesc.mDesc.mSize = aaJointBufferDesc.mDesc.mStructStride * aaJointBufferDesc.mDesc.mElementCount;
+			//Filled from the upload ring, the accelerator reads it as a structured buffer.
 			aaJointBufferDesc.mDesc.pName = "JointModelMats";
-			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+			aaJointBufferDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
 			aaJointBufferDesc.pData = NULL;
 			aaJointBufferDesc.ppBuffer = &pBufferJointModelMats[i]->buffer;
 			addResource(&aaJointBufferDesc, NULL);
@@ -1505,89 +3411,886 @@ class ImposterRendering: public IApp
 			aaJointBufferDesc.mDesc.mStructStride = sizeof(mat4);
 			aaJointBufferDesc.mDesc.mSize = aaJointBufferDesc.mDesc.mStructStride * aaJointBufferDesc.mDesc.mElementCount;
 			aaJointBufferDesc.mDesc.pName = "JointWorldMats";
-			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+			aaJointBufferDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
 			aaJointBufferDesc.pData = NULL;
 			aaJointBufferDesc.ppBuffer = &pBufferJointWorldMats[i]->buffer;
 			addResource(&aaJointBufferDesc, NULL);
 			pBufferJointWorldMats[i]->size = aaJointBufferDesc.mDesc.mSize;
-		}
-	}
 
-	void InitFrustumResource()
-	{
-		BufferLoadDesc frustumBufferDesc{};
-		frustumBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		frustumBufferDesc.mDesc.mElementCount = 6;
-		frustumBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
-		frustumBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
-		frustumBufferDesc.mDesc.mStructStride = sizeof(float4);
-		frustumBufferDesc.mDesc.mSize = frustumBufferDesc.mDesc.mStructStride * frustumBufferDesc.mDesc.mElementCount;
-		frustumBufferDesc.mDesc.pName = "Frustum Blocks Buffer";
+			//CPU copy of the world mats, read once this slot's fence signaled.
+			aaJointBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+			aaJointBufferDesc.mDesc.pName = "JointWorldMatsReadback";
+			aaJointBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+			aaJointBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+			aaJointBufferDesc.mDesc.mStartState = RESOURCE_STATE_COPY_DEST;
+			aaJointBufferDesc.ppBuffer = &pBufferJointWorldMatsReadback[i]->buffer;
+			addResource(&aaJointBufferDesc, NULL);
+			pBufferJointWorldMatsReadback[i]->size = aaJointBufferDesc.mDesc.mSize;
 
-		frustumBufferDesc.ppBuffer = &pBufferFrustumPlanes->buffer;
-		frustumBufferDesc.pData = NULL;
-		addResource(&frustumBufferDesc, NULL);
-		pBufferFrustumPlanes->size = frustumBufferDesc.mDesc.mSize;
+			aaJointBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+			aaJointBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		}
 	}
 
-	void InitCameraControllers()
+	void InitJointLevels()
 	{
-		CameraMotionParameters cmp{ 50.0f, 75.0f, 150.0f, 0.5f, 0.5f };
-
-		vec3 lookAt{ 0.f, 0.f, -1.f };
+		//Bucket joints by hierarchy depth so every joint of a level resolves in parallel behind one barrier.
+		const uint32_t jointCount = gStickFigureAnimObject->mRig->mNumJoints;
+		const int16_t* pParents = gStickFigureAnimObject->mRig->mSkeleton.joint_parents().begin();
 
-		const float aspectInverse = (float)mSettings.mHeight / (float)mSettings.mWidth;
-		const float horizontal_fov = PI / 2.f;
+		uint32_t* pDepths = (uint32_t*)tf_malloc(sizeof(uint32_t) * jointCount);
+		uint32_t* pOrder = (uint32_t*)tf_malloc(sizeof(uint32_t) * jointCount);
+		uint32_t* pRanges = (uint32_t*)tf_calloc(jointCount * 2, sizeof(uint32_t));
 
-		const float zNear = 0.1f;
-		const float zFar = 50.f;
+		//Parents always come before their children in the skeleton.
+		gJointLevelCount = 0;
+		for (uint32_t i = 0; i < jointCount; ++i)
+		{
+			pDepths[i] = pParents[i] < 0 ? 0 : pDepths[pParents[i]] + 1;
+			gJointLevelCount = max(gJointLevelCount, pDepths[i] + 1);
+			++pRanges[pDepths[i] * 2 + 1];
+		}
 
-		CameraMatrix projMat = CameraMatrix::perspectiveReverseZ(horizontal_fov, aspectInverse, zNear, zFar);
+		for (uint32_t level = 1; level < gJointLevelCount; ++level)
+			pRanges[level * 2] = pRanges[(level - 1) * 2] + pRanges[(level - 1) * 2 + 1];
+
+		uint32_t* pCursor = (uint32_t*)tf_calloc(gJointLevelCount, sizeof(uint32_t));
+		for (uint32_t i = 0; i < jointCount; ++i)
+			pOrder[pRanges[pDepths[i] * 2] + pCursor[pDepths[i]]++] = i;
+
+		BufferLoadDesc levelDesc{};
+		levelDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		levelDesc.mDesc.mElementCount = jointCount;
+		levelDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		levelDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		levelDesc.mDesc.mStructStride = sizeof(uint32_t);
+		levelDesc.mDesc.mSize = levelDesc.mDesc.mStructStride * levelDesc.mDesc.mElementCount;
+		levelDesc.mDesc.pName = "JointLevelOrder";
+		levelDesc.pData = pOrder;
+		levelDesc.ppBuffer = &pBufferJointLevelOrder->buffer;
+		addResource(&levelDesc, NULL);
+		pBufferJointLevelOrder->size = levelDesc.mDesc.mSize;
+
+		levelDesc.mDesc.mElementCount = gJointLevelCount;
+		levelDesc.mDesc.mStructStride = sizeof(uint32_t) * 2;
+		levelDesc.mDesc.mSize = levelDesc.mDesc.mStructStride * levelDesc.mDesc.mElementCount;
+		levelDesc.mDesc.pName = "JointLevelRanges";
+		levelDesc.pData = pRanges;
+		levelDesc.ppBuffer = &pBufferJointLevelRanges->buffer;
+		addResource(&levelDesc, NULL);
+		pBufferJointLevelRanges->size = levelDesc.mDesc.mSize;
+
+		//Uploads copy from these, so wait before freeing.
+		waitForAllResourceLoads();
+		tf_free(pCursor);
+		tf_free(pRanges);
+		tf_free(pOrder);
+		tf_free(pDepths);
 
-		//Camera for billboard capturing.
-		billboardCamera = initFpsCameraController({ 0.f, 4.f, 5.3f }, lookAt);
-		billboardCamera->setMotionParameters(cmp);
-		billboardCamera->setViewRotationXY({ 0.34f, 3.14f });
+		LOGF(eINFO, "Joint hierarchy: %u joints in %u levels", jointCount, gJointLevelCount);
+	}
 
-		mat4 viewMat = billboardCamera->getViewMatrix();
-		float rad2 = degToRad(2.f);
+	void UploadArchetypeSkinData()
+	{
+		//Live archetype's parents, remaps and bind poses at the start of the buffers sized for the largest one.
+		const Rig* pRig = gStickFigureAnimObject->mRig;
+		pBufferJointParentsIndex->UpdateData((void*)pRig->mSkeleton.joint_parents().begin(), pRig->mNumJoints * sizeof(int16_t));
+		pBufferJointRemaps->UpdateData(pGeomData->pJointRemaps, pGeomData->mJointCount * sizeof(uint32_t));
+		pBufferInverseBindPoses->UpdateData(pGeomData->pInverseBindPoses, pGeomData->mJointCount * sizeof(mat4));
+	}
 
-		imposterProjMatrix = projMat.getPrimaryMatrix();
-		imposterViewMatrix = viewMat;
+	void RemoveJointLevels()
+	{
+		removeResource(pBufferJointLevelOrder->buffer);
+		removeResource(pBufferJointLevelRanges->buffer);
+	}
 
-		//Setting imposter matrices
-		for (int i = 0; i < TextureCount; ++i)
+	void InitBonePaletteResource()
+	{
+		//Mesh joint -> rig joint remap and inverse bind poses, so the accelerator can finish the palette itself.
+		BufferLoadDesc skinDataDesc{};
+		skinDataDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		skinDataDesc.mDesc.mElementCount = GetMaxArchetypeJointCount();
+		skinDataDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		skinDataDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		skinDataDesc.mDesc.mStructStride = sizeof(uint32_t);
+		skinDataDesc.mDesc.mSize = skinDataDesc.mDesc.mStructStride * skinDataDesc.mDesc.mElementCount;
+		skinDataDesc.mDesc.pName = "JointRemaps";
+		skinDataDesc.ppBuffer = &pBufferJointRemaps->buffer;
+		skinDataDesc.pData = NULL;
+		addResource(&skinDataDesc, NULL);
+		pBufferJointRemaps->size = skinDataDesc.mDesc.mSize;
+
+		skinDataDesc.mDesc.mStructStride = sizeof(mat4);
+		skinDataDesc.mDesc.mSize = skinDataDesc.mDesc.mStructStride * skinDataDesc.mDesc.mElementCount;
+		skinDataDesc.mDesc.pName = "InverseBindPoses";
+		skinDataDesc.ppBuffer = &pBufferInverseBindPoses->buffer;
+		skinDataDesc.pData = NULL;
+		addResource(&skinDataDesc, NULL);
+		pBufferInverseBindPoses->size = skinDataDesc.mDesc.mSize;
+		UploadArchetypeSkinData();
+
+		//Same layout as UniformDataBones, bound as boneMatrices.
+		BufferLoadDesc paletteDesc{};
+		paletteDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		paletteDesc.mDesc.mElementCount = MAX_NUM_BONES * 4;
+		paletteDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		paletteDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		paletteDesc.mDesc.mStartState = RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+		paletteDesc.mDesc.mStructStride = sizeof(vec4);
+		paletteDesc.mDesc.mSize = sizeof(UniformDataBones);
+		paletteDesc.mDesc.pName = "BonePalette";
+		paletteDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
-			imposterRotationMatrices[i] = mat4::rotationY(rad2 * static_cast<float>(i));
+			paletteDesc.ppBuffer = &pBufferBonePalette[i]->buffer;
+			addResource(&paletteDesc, NULL);
+			pBufferBonePalette[i]->size = paletteDesc.mDesc.mSize;
 		}
+	}
 
-		vec3 camPos{ -3.0f, 3.0f, 5.0f };
-		lookAt = { 0.0f, 1.0f, 0.0f };
+	void BuildPoseCache(uint32_t sampleRate)
+	{
+		//Sample the looping clip once into joint local TRS, runtime poses become table lookups.
+		const float savedTime = gUIData.mClip.mAnimationTime;
+		const int16_t* pParents = gStickFigureAnimObject->mRig->mSkeleton.joint_parents().begin();
+
+		gPoseCache.mJointCount = gStickFigureAnimObject->mRig->mNumJoints;
+		gPoseCache.mSampleRate = sampleRate;
+		gPoseCache.mDuration = gClipController->mDuration;
+		//Evenly spaced over the whole clip so the last sample blends back into the first.
+		gPoseCache.mFrameCount = max(1u, (uint32_t)(gPoseCache.mDuration * sampleRate + 0.5f));
+
+		const uint32_t poseCount = gPoseCache.mFrameCount * gPoseCache.mJointCount;
+		gPoseCache.pRotations = (float4*)tf_malloc(sizeof(float4) * poseCount);
+		gPoseCache.pTranslations = (float3*)tf_malloc(sizeof(float3) * poseCount);
+		gPoseCache.pScales = (float3*)tf_malloc(sizeof(float3) * poseCount);
+
+		float maxScaleError = 0.f;
+		for (uint32_t frame = 0; frame < gPoseCache.mFrameCount; ++frame)
+		{
+			gClipController->SetTimeRatioHard(gPoseCache.mDuration * (float)frame / (float)gPoseCache.mFrameCount);
+			gStickFigureAnimObject->Update(0.f);
+			gStickFigureAnimObject->ComputePose(mat4::identity());
 
-		mainCamera = initFpsCameraController(camPos, lookAt);
-		mainCamera->setMotionParameters(cmp);
+			for (uint32_t joint = 0; joint < gPoseCache.mJointCount; ++joint)
+			{
+				const mat4& model = gStickFigureAnimObject->mJointWorldMats[joint];
+				const mat4 local = pParents[joint] < 0 ? model : inverse(gStickFigureAnimObject->mJointWorldMats[pParents[joint]]) * model;
+
+				const vec3 axisX = local.getCol0().getXYZ();
+				const vec3 axisY = local.getCol1().getXYZ();
+				const vec3 axisZ = local.getCol2().getXYZ();
+				const vec3 scale = vec3(length(axisX), length(axisY), length(axisZ));
+				//A joint scaled to zero has no recoverable rotation, keep identity instead of dividing by zero.
+				const float minScale = min(scale.getX(), min(scale.getY(), scale.getZ()));
+				const Quat rotation = minScale > 1e-6f ? normalize(Quat(mat3(axisX / scale.getX(), axisY / scale.getY(), axisZ / scale.getZ()))) : Quat::identity();
+				const vec3 translation = local.getTranslation();
+
+				const uint32_t index = frame * gPoseCache.mJointCount + joint;
+				gPoseCache.pRotations[index] = float4(rotation.getX(), rotation.getY(), rotation.getZ(), rotation.getW());
+				gPoseCache.pTranslations[index] = float3(translation.getX(), translation.getY(), translation.getZ());
+				gPoseCache.pScales[index] = float3(scale.getX(), scale.getY(), scale.getZ());
+			}
 
-		secondCamera = initFpsCameraController(camPos, lookAt);
-		secondCamera->setMotionParameters(cmp);
+			for (uint32_t bone = 0; bone < pGeomData->mJointCount; ++bone)
+			{
+				const mat4 skin = gStickFigureAnimObject->mJointWorldMats[pGeomData->pJointRemaps[bone]] * pGeomData->pInverseBindPoses[bone];
+				const vec3 lengths = vec3(length(skin.getCol0().getXYZ()), length(skin.getCol1().getXYZ()), length(skin.getCol2().getXYZ()));
+				maxScaleError = max(maxScaleError, maxElem(absPerElem(lengths - vec3(1.f))));
+			}
+		}
+		gRigHasScale = maxScaleError > 1e-3f;
+		gClipController->SetTimeRatioHard(savedTime);
+
+		BufferLoadDesc poseDesc{};
+		poseDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		poseDesc.mDesc.mElementCount = poseCount;
+		poseDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		poseDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+
+		poseDesc.mDesc.mStructStride = sizeof(float4);
+		poseDesc.mDesc.mSize = poseDesc.mDesc.mStructStride * poseDesc.mDesc.mElementCount;
+		poseDesc.mDesc.pName = "PoseCacheRotations";
+		poseDesc.pData = gPoseCache.pRotations;
+		poseDesc.ppBuffer = &pBufferPoseRotations->buffer;
+		addResource(&poseDesc, NULL);
+		pBufferPoseRotations->size = poseDesc.mDesc.mSize;
+
+		poseDesc.mDesc.mStructStride = sizeof(float3);
+		poseDesc.mDesc.mSize = poseDesc.mDesc.mStructStride * poseDesc.mDesc.mElementCount;
+		poseDesc.mDesc.pName = "PoseCacheTranslations";
+		poseDesc.pData = gPoseCache.pTranslations;
+		poseDesc.ppBuffer = &pBufferPoseTranslations->buffer;
+		addResource(&poseDesc, NULL);
+		pBufferPoseTranslations->size = poseDesc.mDesc.mSize;
+
+		poseDesc.mDesc.pName = "PoseCacheScales";
+		poseDesc.pData = gPoseCache.pScales;
+		poseDesc.ppBuffer = &pBufferPoseScales->buffer;
+		addResource(&poseDesc, NULL);
+		pBufferPoseScales->size = poseDesc.mDesc.mSize;
+	}
 
-		light = initFpsCameraController({ 0.f, 0.f, 0.f }, {});
+	void RemovePoseCache()
+	{
+		removeResource(pBufferPoseRotations->buffer);
+		removeResource(pBufferPoseTranslations->buffer);
+		removeResource(pBufferPoseScales->buffer);
+
+		tf_free(gPoseCache.pRotations);
+		tf_free(gPoseCache.pTranslations);
+		tf_free(gPoseCache.pScales);
+		gPoseCache = {};
 	}
 
-	
-	////////////////////////////////////////////////////////////////////////////////////
-	//										Load Funcs								  //
-	////////////////////////////////////////////////////////////////////////////////////
-	void AddShaders()
+	void ApplyPoseCacheSampleRate(uint32_t sampleRate)
 	{
-		//Setup shaders.
-		ShaderLoadDesc planeShader{};
-		planeShader.mStages[0].pFileName = "plane.vert";
-		planeShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
-		planeShader.mStages[1].pFileName = "plane.frag";
+		//Stream sizes change, rebuild them and everything bound to them.
+		DrainQueues();
+		RemovePoseCache();
+		BuildPoseCache(sampleRate);
+		waitForAllResourceLoads();
+		PrepareDescriptorSets();
+	}
+
+	uint64_t GetPoseCacheFootprint()
+	{
+		return (uint64_t)gPoseCache.mFrameCount * gPoseCache.mJointCount * (sizeof(float4) + sizeof(float3) * 2);
+	}
+
+	void InitNearFieldResource()
+	{
+		//Promoted instance ids, appended by the angle compute.
+		BufferLoadDesc nearFieldIndicesDesc{};
+		nearFieldIndicesDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		nearFieldIndicesDesc.mDesc.mElementCount = MaxNearFieldCount;
+		nearFieldIndicesDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		nearFieldIndicesDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		nearFieldIndicesDesc.mDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		nearFieldIndicesDesc.mDesc.mStructStride = sizeof(uint32_t);
+		nearFieldIndicesDesc.mDesc.mSize = nearFieldIndicesDesc.mDesc.mStructStride * nearFieldIndicesDesc.mDesc.mElementCount;
+		nearFieldIndicesDesc.mDesc.pName = "NearFieldIndices";
+		nearFieldIndicesDesc.pData = NULL;
+
+		//One palette slice per promoted slot, instance i of the draw skins with slice i.
+		BufferLoadDesc nearFieldPaletteDesc = nearFieldIndicesDesc;
+		nearFieldPaletteDesc.mDesc.mElementCount = MaxNearFieldCount * MAX_NUM_BONES * 4;
+		nearFieldPaletteDesc.mDesc.mStructStride = sizeof(vec4);
+		nearFieldPaletteDesc.mDesc.mSize = nearFieldPaletteDesc.mDesc.mStructStride * nearFieldPaletteDesc.mDesc.mElementCount;
+		nearFieldPaletteDesc.mDesc.pName = "NearFieldPalettes";
+
+		//Indexed draw args, instance count is the append counter.
+		IndirectDrawIndexArguments resetArgs = { pGeom->mIndexCount, 0, 0, 0, 0 };
+
+		BufferLoadDesc nearFieldArgsDesc{};
+		nearFieldArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_INDIRECT_BUFFER;
+		nearFieldArgsDesc.mDesc.mElementCount = sizeof(IndirectDrawIndexArguments) / sizeof(uint32_t);
+		nearFieldArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		nearFieldArgsDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		nearFieldArgsDesc.mDesc.mStartState = RESOURCE_STATE_INDIRECT_ARGUMENT | RESOURCE_STATE_SHADER_RESOURCE;
+		nearFieldArgsDesc.mDesc.mStructStride = sizeof(uint32_t);
+		nearFieldArgsDesc.mDesc.mSize = sizeof(IndirectDrawIndexArguments);
+		nearFieldArgsDesc.mDesc.pName = "NearFieldArgs";
+		nearFieldArgsDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			nearFieldIndicesDesc.ppBuffer = &pBufferNearFieldIndices[i]->buffer;
+			addResource(&nearFieldIndicesDesc, NULL);
+			pBufferNearFieldIndices[i]->size = nearFieldIndicesDesc.mDesc.mSize;
+
+			nearFieldPaletteDesc.ppBuffer = &pBufferNearFieldPalettes[i]->buffer;
+			addResource(&nearFieldPaletteDesc, NULL);
+			pBufferNearFieldPalettes[i]->size = nearFieldPaletteDesc.mDesc.mSize;
+
+			nearFieldArgsDesc.ppBuffer = &pBufferNearFieldArgs[i]->buffer;
+			addResource(&nearFieldArgsDesc, NULL);
+			pBufferNearFieldArgs[i]->size = nearFieldArgsDesc.mDesc.mSize;
+		}
+
+		nearFieldArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		nearFieldArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		nearFieldArgsDesc.mDesc.mStartState = RESOURCE_STATE_COPY_SOURCE;
+		nearFieldArgsDesc.mDesc.pName = "NearFieldArgsReset";
+		nearFieldArgsDesc.ppBuffer = &pBufferNearFieldArgsReset->buffer;
+		nearFieldArgsDesc.pData = &resetArgs;
+		addResource(&nearFieldArgsDesc, NULL);
+		pBufferNearFieldArgsReset->size = nearFieldArgsDesc.mDesc.mSize;
+
+		//Bins split [0, nearFieldDistance], the first pass counts candidates so the second promotes the nearest.
+		uint32_t zeroHistogram[NearFieldHistogramBinCount + 1] = {};
+
+		BufferLoadDesc histogramDesc{};
+		histogramDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		histogramDesc.mDesc.mElementCount = NearFieldHistogramBinCount + 1;
+		histogramDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		histogramDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		histogramDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
+		histogramDesc.mDesc.mStructStride = sizeof(uint32_t);
+		histogramDesc.mDesc.mSize = sizeof(zeroHistogram);
+		histogramDesc.mDesc.pName = "NearFieldHistogram";
+		histogramDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			histogramDesc.ppBuffer = &pBufferNearFieldHistogram[i]->buffer;
+			addResource(&histogramDesc, NULL);
+			pBufferNearFieldHistogram[i]->size = histogramDesc.mDesc.mSize;
+		}
+
+		histogramDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		histogramDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		histogramDesc.mDesc.mStartState = RESOURCE_STATE_COPY_SOURCE;
+		histogramDesc.mDesc.pName = "NearFieldHistogramReset";
+		histogramDesc.ppBuffer = &pBufferNearFieldHistogramReset->buffer;
+		histogramDesc.pData = zeroHistogram;
+		addResource(&histogramDesc, NULL);
+		pBufferNearFieldHistogramReset->size = histogramDesc.mDesc.mSize;
+
+		BufferLoadDesc crowdPaletteDesc{};
+		crowdPaletteDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		crowdPaletteDesc.mDesc.mElementCount = MaxCrowdAnimCount * GetMaxArchetypeJointCount() * 4;
+		crowdPaletteDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		crowdPaletteDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+		crowdPaletteDesc.mDesc.mStructStride = sizeof(vec4);
+		crowdPaletteDesc.mDesc.mSize = crowdPaletteDesc.mDesc.mStructStride * crowdPaletteDesc.mDesc.mElementCount;
+		crowdPaletteDesc.mDesc.pName = "CrowdPalettes";
+		crowdPaletteDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			crowdPaletteDesc.ppBuffer = &pBufferCrowdPalettes[i]->buffer;
+			addResource(&crowdPaletteDesc, NULL);
+			pBufferCrowdPalettes[i]->size = crowdPaletteDesc.mDesc.mSize;
+		}
+	}
+
+	void InitVatResource()
+	{
+		//Every clip sample in the skinning compute output layout, filled by BakeVertexAnimation.
+		BufferLoadDesc vatDesc{};
+		vatDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		vatDesc.mDesc.mElementCount = (uint64_t)GetMaxArchetypeVertexCount() * VatFrameCount * (SkinnedVertexStride / sizeof(float));
+		vatDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		vatDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		vatDesc.mDesc.mStartState = RESOURCE_STATE_COPY_DEST;
+		vatDesc.mDesc.mStructStride = sizeof(float);
+		vatDesc.mDesc.mSize = (uint64_t)GetMaxArchetypeVertexCount() * VatFrameCount * SkinnedVertexStride;
+		vatDesc.mDesc.pName = "VertexAnimation";
+		vatDesc.pData = NULL;
+		vatDesc.ppBuffer = &pBufferVertexAnimation->buffer;
+		addResource(&vatDesc, NULL);
+		pBufferVertexAnimation->size = vatDesc.mDesc.mSize;
+
+		//Mid field instance ids, appended by the angle compute.
+		BufferLoadDesc vatIndicesDesc{};
+		vatIndicesDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		vatIndicesDesc.mDesc.mElementCount = MaxVatCount;
+		vatIndicesDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		vatIndicesDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		vatIndicesDesc.mDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		vatIndicesDesc.mDesc.mStructStride = sizeof(uint32_t);
+		vatIndicesDesc.mDesc.mSize = vatIndicesDesc.mDesc.mStructStride * vatIndicesDesc.mDesc.mElementCount;
+		vatIndicesDesc.mDesc.pName = "VatIndices";
+		vatIndicesDesc.pData = NULL;
+
+		IndirectDrawIndexArguments resetArgs = { pGeom->mIndexCount, 0, 0, 0, 0 };
+
+		BufferLoadDesc vatArgsDesc{};
+		vatArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_INDIRECT_BUFFER;
+		vatArgsDesc.mDesc.mElementCount = sizeof(IndirectDrawIndexArguments) / sizeof(uint32_t);
+		vatArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		vatArgsDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		vatArgsDesc.mDesc.mStartState = RESOURCE_STATE_INDIRECT_ARGUMENT;
+		vatArgsDesc.mDesc.mStructStride = sizeof(uint32_t);
+		vatArgsDesc.mDesc.mSize = sizeof(IndirectDrawIndexArguments);
+		vatArgsDesc.mDesc.pName = "VatArgs";
+		vatArgsDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			vatIndicesDesc.ppBuffer = &pBufferVatIndices[i]->buffer;
+			addResource(&vatIndicesDesc, NULL);
+			pBufferVatIndices[i]->size = vatIndicesDesc.mDesc.mSize;
+
+			vatArgsDesc.ppBuffer = &pBufferVatArgs[i]->buffer;
+			addResource(&vatArgsDesc, NULL);
+			pBufferVatArgs[i]->size = vatArgsDesc.mDesc.mSize;
+		}
+
+		vatArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		vatArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		vatArgsDesc.mDesc.mStartState = RESOURCE_STATE_COPY_SOURCE;
+		vatArgsDesc.mDesc.pName = "VatArgsReset";
+		vatArgsDesc.ppBuffer = &pBufferVatArgsReset->buffer;
+		vatArgsDesc.pData = &resetArgs;
+		addResource(&vatArgsDesc, NULL);
+		pBufferVatArgsReset->size = vatArgsDesc.mDesc.mSize;
+
+		//Needs the skinning compute pipeline, baked on the first Draw.
+		gVatBakeRequested = true;
+	}
+
+	void InitSkinnedVertexResource()
+	{
+		//Position, normal, uv per posed vertex.
+		BufferLoadDesc skinnedVertexBufferDesc{};
+		skinnedVertexBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_VERTEX_BUFFER;
+		//Sized for the largest archetype, the bake skins each one in turn.
+		skinnedVertexBufferDesc.mDesc.mElementCount = GetMaxArchetypeVertexCount();
+		skinnedVertexBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		skinnedVertexBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		skinnedVertexBufferDesc.mDesc.mStartState = RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+		skinnedVertexBufferDesc.mDesc.mStructStride = SkinnedVertexStride;
+		skinnedVertexBufferDesc.mDesc.mSize = skinnedVertexBufferDesc.mDesc.mStructStride * skinnedVertexBufferDesc.mDesc.mElementCount;
+		skinnedVertexBufferDesc.mDesc.pName = "SkinnedVertices";
+		skinnedVertexBufferDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			skinnedVertexBufferDesc.ppBuffer = &pBufferSkinnedVertices[i]->buffer;
+			addResource(&skinnedVertexBufferDesc, NULL);
+			pBufferSkinnedVertices[i]->size = skinnedVertexBufferDesc.mDesc.mSize;
+		}
+	}
+
+	void InitCaptureScheduleResource()
+	{
+		//Angle bin usage, written by the angle compute and copied into a readback slot per frame.
+		BufferLoadDesc angleBinBufferDesc{};
+		angleBinBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		angleBinBufferDesc.mDesc.mElementCount = TextureCount;
+		angleBinBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		angleBinBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		angleBinBufferDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
+		angleBinBufferDesc.mDesc.mStructStride = sizeof(uint32_t);
+		angleBinBufferDesc.mDesc.mSize = angleBinBufferDesc.mDesc.mStructStride * angleBinBufferDesc.mDesc.mElementCount;
+		angleBinBufferDesc.mDesc.pName = "AngleBinUsage";
+		angleBinBufferDesc.ppBuffer = &pBufferAngleBinUsage->buffer;
+		//Zeroed, stamps start at 1 so no bin reads as used before the angle compute wrote it.
+		memset(angleBinUsage, 0, sizeof(angleBinUsage));
+		angleBinBufferDesc.pData = angleBinUsage;
+
+		addResource(&angleBinBufferDesc, NULL);
+		pBufferAngleBinUsage->size = angleBinBufferDesc.mDesc.mSize;
+
+		angleBinBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		angleBinBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+		angleBinBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+		angleBinBufferDesc.mDesc.mStartState = RESOURCE_STATE_COPY_DEST;
+		angleBinBufferDesc.mDesc.pName = "AngleBinReadback";
+		angleBinBufferDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			angleBinBufferDesc.ppBuffer = &pBufferAngleBinReadback[i]->buffer;
+			addResource(&angleBinBufferDesc, NULL);
+			pBufferAngleBinReadback[i]->size = angleBinBufferDesc.mDesc.mSize;
+		}
+
+		BufferLoadDesc viewListBufferDesc{};
+		viewListBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		viewListBufferDesc.mDesc.mElementCount = TextureCount;
+		viewListBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		viewListBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+		viewListBufferDesc.mDesc.mStructStride = sizeof(uint32_t);
+		viewListBufferDesc.mDesc.mSize = viewListBufferDesc.mDesc.mStructStride * viewListBufferDesc.mDesc.mElementCount;
+		viewListBufferDesc.mDesc.pName = "CaptureViewList";
+		viewListBufferDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			viewListBufferDesc.ppBuffer = &pBufferCaptureViewList[i]->buffer;
+			addResource(&viewListBufferDesc, NULL);
+			pBufferCaptureViewList[i]->size = viewListBufferDesc.mDesc.mSize;
+		}
+	}
+
+	void InitCompactionResource()
+	{
+		//Visible instance indices, appended by the angle compute.
+		BufferLoadDesc visibleIndicesDesc{};
+		visibleIndicesDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		visibleIndicesDesc.mDesc.mElementCount = MaxImposterCount;
+		visibleIndicesDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		visibleIndicesDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		visibleIndicesDesc.mDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		visibleIndicesDesc.mDesc.mStructStride = sizeof(uint32_t);
+		visibleIndicesDesc.mDesc.mSize = visibleIndicesDesc.mDesc.mStructStride * visibleIndicesDesc.mDesc.mElementCount;
+		visibleIndicesDesc.mDesc.pName = "VisibleImposterIndices";
+		visibleIndicesDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			visibleIndicesDesc.ppBuffer = &pBufferVisibleIndices[i]->buffer;
+			addResource(&visibleIndicesDesc, NULL);
+			pBufferVisibleIndices[i]->size = visibleIndicesDesc.mDesc.mSize;
+		}
+
+		visibleIndicesDesc.mDesc.pName = "ShadowCasterIndices";
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			visibleIndicesDesc.ppBuffer = &pBufferShadowIndices[i]->buffer;
+			addResource(&visibleIndicesDesc, NULL);
+			pBufferShadowIndices[i]->size = visibleIndicesDesc.mDesc.mSize;
+		}
+
+		//Draw args, instance count is the append counter.
+		IndirectDrawArguments resetArgs = { 6, 0, 0, 0 };
+
+		BufferLoadDesc indirectArgsDesc{};
+		indirectArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_INDIRECT_BUFFER;
+		indirectArgsDesc.mDesc.mElementCount = sizeof(IndirectDrawArguments) / sizeof(uint32_t);
+		indirectArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		indirectArgsDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		indirectArgsDesc.mDesc.mStartState = RESOURCE_STATE_INDIRECT_ARGUMENT;
+		indirectArgsDesc.mDesc.mStructStride = sizeof(uint32_t);
+		indirectArgsDesc.mDesc.mSize = sizeof(IndirectDrawArguments);
+		indirectArgsDesc.mDesc.pName = "QuadIndirectArgs";
+		indirectArgsDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			indirectArgsDesc.ppBuffer = &pBufferQuadIndirectArgs[i]->buffer;
+			addResource(&indirectArgsDesc, NULL);
+			pBufferQuadIndirectArgs[i]->size = indirectArgsDesc.mDesc.mSize;
+		}
+
+		indirectArgsDesc.mDesc.pName = "ShadowIndirectArgs";
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			indirectArgsDesc.ppBuffer = &pBufferShadowIndirectArgs[i]->buffer;
+			addResource(&indirectArgsDesc, NULL);
+			pBufferShadowIndirectArgs[i]->size = indirectArgsDesc.mDesc.mSize;
+		}
+
+		//Copied over both args every frame before the angle compute appends.
+		indirectArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		indirectArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		indirectArgsDesc.mDesc.mStartState = RESOURCE_STATE_COPY_SOURCE;
+		indirectArgsDesc.mDesc.pName = "QuadIndirectArgsReset";
+		indirectArgsDesc.ppBuffer = &pBufferQuadIndirectArgsReset->buffer;
+		indirectArgsDesc.pData = &resetArgs;
+		addResource(&indirectArgsDesc, NULL);
+		pBufferQuadIndirectArgsReset->size = indirectArgsDesc.mDesc.mSize;
+
+		//Surviving clusters and the group count of the angle compute that walks them.
+		visibleIndicesDesc.mDesc.mElementCount = MaxImposterClusterCount;
+		visibleIndicesDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
+		visibleIndicesDesc.mDesc.mSize = visibleIndicesDesc.mDesc.mStructStride * visibleIndicesDesc.mDesc.mElementCount;
+		visibleIndicesDesc.mDesc.pName = "VisibleImposterClusters";
+
+		IndirectDispatchArguments resetDispatchArgs = { 0, 1, 1 };
+		indirectArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_INDIRECT_BUFFER;
+		indirectArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		indirectArgsDesc.mDesc.mStartState = RESOURCE_STATE_INDIRECT_ARGUMENT;
+		indirectArgsDesc.mDesc.mElementCount = sizeof(IndirectDispatchArguments) / sizeof(uint32_t);
+		indirectArgsDesc.mDesc.mSize = sizeof(IndirectDispatchArguments);
+		indirectArgsDesc.mDesc.pName = "ClusterDispatchArgs";
+		indirectArgsDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			visibleIndicesDesc.ppBuffer = &pBufferVisibleClusters[i]->buffer;
+			addResource(&visibleIndicesDesc, NULL);
+			pBufferVisibleClusters[i]->size = visibleIndicesDesc.mDesc.mSize;
+
+			indirectArgsDesc.ppBuffer = &pBufferClusterDispatchArgs[i]->buffer;
+			addResource(&indirectArgsDesc, NULL);
+			pBufferClusterDispatchArgs[i]->size = indirectArgsDesc.mDesc.mSize;
+		}
+
+		indirectArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		indirectArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		indirectArgsDesc.mDesc.mStartState = RESOURCE_STATE_COPY_SOURCE;
+		indirectArgsDesc.mDesc.pName = "ClusterDispatchArgsReset";
+		indirectArgsDesc.ppBuffer = &pBufferClusterDispatchArgsReset->buffer;
+		indirectArgsDesc.pData = &resetDispatchArgs;
+		addResource(&indirectArgsDesc, NULL);
+		pBufferClusterDispatchArgsReset->size = indirectArgsDesc.mDesc.mSize;
+	}
+
+	void InitOcclusionResource()
+	{
+		//Candidates and survivors of the second phase, same layout as the visible list.
+		BufferLoadDesc indicesDesc{};
+		indicesDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		indicesDesc.mDesc.mElementCount = MaxImposterCount;
+		indicesDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		indicesDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		indicesDesc.mDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		indicesDesc.mDesc.mStructStride = sizeof(uint32_t);
+		indicesDesc.mDesc.mSize = indicesDesc.mDesc.mStructStride * indicesDesc.mDesc.mElementCount;
+		indicesDesc.pData = NULL;
+
+		BufferLoadDesc retestArgsDesc{};
+		retestArgsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER | DESCRIPTOR_TYPE_INDIRECT_BUFFER;
+		retestArgsDesc.mDesc.mElementCount = sizeof(IndirectDrawArguments) / sizeof(uint32_t);
+		retestArgsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		retestArgsDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		retestArgsDesc.mDesc.mStartState = RESOURCE_STATE_INDIRECT_ARGUMENT;
+		retestArgsDesc.mDesc.mStructStride = sizeof(uint32_t);
+		retestArgsDesc.mDesc.mSize = sizeof(IndirectDrawArguments);
+		retestArgsDesc.mDesc.pName = "RetestIndirectArgs";
+		retestArgsDesc.pData = NULL;
+
+		BufferLoadDesc readbackDesc{};
+		readbackDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		readbackDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+		readbackDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+		readbackDesc.mDesc.mStartState = RESOURCE_STATE_COPY_DEST;
+		readbackDesc.mDesc.mSize = sizeof(gOcclusionCounters);
+		readbackDesc.mDesc.pName = "OcclusionReadback";
+		readbackDesc.pData = NULL;
+
+		//One group per 64 candidates, counted up by the angle compute as it appends them.
+		BufferLoadDesc retestDispatchDesc = retestArgsDesc;
+		retestDispatchDesc.mDesc.mElementCount = sizeof(IndirectDispatchArguments) / sizeof(uint32_t);
+		retestDispatchDesc.mDesc.mSize = sizeof(IndirectDispatchArguments);
+		retestDispatchDesc.mDesc.pName = "RetestDispatchArgs";
+
+		//Tested / candidate / recovered counters, zeroed from a static copy every frame.
+		uint32_t zeroCounters[OCCLUSION_COUNTER_COUNT] = {};
+
+		BufferLoadDesc countersDesc{};
+		countersDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_RW_BUFFER;
+		countersDesc.mDesc.mElementCount = OCCLUSION_COUNTER_COUNT;
+		countersDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		countersDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		countersDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
+		countersDesc.mDesc.mStructStride = sizeof(uint32_t);
+		countersDesc.mDesc.mSize = sizeof(zeroCounters);
+		countersDesc.mDesc.pName = "OcclusionCounters";
+		countersDesc.pData = NULL;
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			//Only ever touched by the two cull passes, stays in UAV.
+			indicesDesc.mDesc.pName = "OcclusionCandidates";
+			indicesDesc.mDesc.mStartState = RESOURCE_STATE_UNORDERED_ACCESS;
+			indicesDesc.ppBuffer = &pBufferOcclusionCandidates[i]->buffer;
+			addResource(&indicesDesc, NULL);
+			pBufferOcclusionCandidates[i]->size = indicesDesc.mDesc.mSize;
+
+			indicesDesc.mDesc.pName = "RetestVisibleIndices";
+			indicesDesc.mDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+			indicesDesc.ppBuffer = &pBufferRetestIndices[i]->buffer;
+			addResource(&indicesDesc, NULL);
+			pBufferRetestIndices[i]->size = indicesDesc.mDesc.mSize;
+
+			retestArgsDesc.ppBuffer = &pBufferRetestIndirectArgs[i]->buffer;
+			addResource(&retestArgsDesc, NULL);
+			pBufferRetestIndirectArgs[i]->size = retestArgsDesc.mDesc.mSize;
+
+			retestDispatchDesc.ppBuffer = &pBufferRetestDispatchArgs[i]->buffer;
+			addResource(&retestDispatchDesc, NULL);
+			pBufferRetestDispatchArgs[i]->size = retestDispatchDesc.mDesc.mSize;
+
+			//Per frame, a frame in flight must not reset counters the retest still reads.
+			countersDesc.ppBuffer = &pBufferOcclusionCounters[i]->buffer;
+			addResource(&countersDesc, NULL);
+			pBufferOcclusionCounters[i]->size = countersDesc.mDesc.mSize;
+
+			readbackDesc.ppBuffer = &pBufferOcclusionReadback[i]->buffer;
+			addResource(&readbackDesc, NULL);
+			pBufferOcclusionReadback[i]->size = readbackDesc.mDesc.mSize;
+		}
+
+		countersDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		countersDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		countersDesc.mDesc.mStartState = RESOURCE_STATE_COPY_SOURCE;
+		countersDesc.mDesc.pName = "OcclusionCountersReset";
+		countersDesc.ppBuffer = &pBufferOcclusionCountersReset->buffer;
+		countersDesc.pData = zeroCounters;
+		addResource(&countersDesc, NULL);
+		pBufferOcclusionCountersReset->size = countersDesc.mDesc.mSize;
+
+		readbackDesc.mDesc.mSize = sizeof(gLatencyTimestamps);
+		readbackDesc.mDesc.pName = "LatencyReadback";
+		readbackDesc.ppBuffer = &pBufferLatencyReadback->buffer;
+		addResource(&readbackDesc, NULL);
+		pBufferLatencyReadback->size = readbackDesc.mDesc.mSize;
+	}
+
+	void InitImposterViewResource()
+	{
+		BufferLoadDesc viewMatsBufferDesc{};
+		viewMatsBufferDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		viewMatsBufferDesc.mDesc.mElementCount = TextureCount;
+		viewMatsBufferDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_ONLY;
+		viewMatsBufferDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		viewMatsBufferDesc.mDesc.mStructStride = sizeof(mat4);
+		viewMatsBufferDesc.mDesc.mSize = viewMatsBufferDesc.mDesc.mStructStride * viewMatsBufferDesc.mDesc.mElementCount;
+		viewMatsBufferDesc.mDesc.pName = "ImposterCaptureViewMats";
+		viewMatsBufferDesc.ppBuffer = &pBufferImposterViewMats->buffer;
+		viewMatsBufferDesc.pData = imposterCaptureViewMats;
+
+		addResource(&viewMatsBufferDesc, NULL);
+		pBufferImposterViewMats->size = viewMatsBufferDesc.mDesc.mSize;
+
+		//Rewritten with the heap, always after the queues drained.
+		BufferLoadDesc heapLayoutsDesc{};
+		heapLayoutsDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_BUFFER;
+		heapLayoutsDesc.mDesc.mElementCount = ImposterTextureHeapSize;
+		heapLayoutsDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_CPU_TO_GPU;
+		heapLayoutsDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_NONE;
+		heapLayoutsDesc.mDesc.mStructStride = sizeof(ImposterHeapLayout);
+		heapLayoutsDesc.mDesc.mSize = heapLayoutsDesc.mDesc.mStructStride * heapLayoutsDesc.mDesc.mElementCount;
+		heapLayoutsDesc.mDesc.pName = "ImposterHeapLayouts";
+		heapLayoutsDesc.ppBuffer = &pBufferImposterHeapLayouts->buffer;
+		heapLayoutsDesc.pData = NULL;
+
+		addResource(&heapLayoutsDesc, NULL);
+		pBufferImposterHeapLayouts->size = heapLayoutsDesc.mDesc.mSize;
+	}
+
+	uint32_t GetImposterViewCount(uint32_t layout)
+	{
+		return layout == IMPOSTER_VIEW_LAYOUT_RING_Y ? TextureCount : OctahedralGridSize * OctahedralGridSize;
+	}
+
+	void BuildImposterViews(uint32_t layout)
+	{
+		//Capture view per atlas slice. Ring views rotate the mesh, octahedral views move the camera.
+		if (layout == IMPOSTER_VIEW_LAYOUT_RING_Y)
+		{
+			float rad2 = degToRad(2.f);
+			for (int i = 0; i < TextureCount; ++i)
+			{
+				imposterRotationMatrices[i] = mat4::rotationY(rad2 * static_cast<float>(i));
+				imposterCaptureViewMats[i] = imposterViewMatrix * imposterRotationMatrices[i];
+			}
+			return;
+		}
+
+		//Orbit the point the billboard camera looks at on the Y axis, at the same distance.
+		mat4 cameraToWorld = inverse(imposterViewMatrix);
+		vec3 eye = cameraToWorld.getTranslation();
+		vec3 forward = normalize(cameraToWorld.getCol2().getXYZ());
+		//A camera looking straight along Y never reaches the axis, orbit the origin instead.
+		float horizontalSq = forward.getX() * forward.getX() + forward.getZ() * forward.getZ();
+		vec3 center = vec3(0.f, 0.f, 0.f);
+		if (horizontalSq > 1e-6f)
+		{
+			float t = -(eye.getX() * forward.getX() + eye.getZ() * forward.getZ()) / horizontalSq;
+			center = eye + forward * t;
+		}
+		float distance = length(eye - center);
+
+		for (uint32_t y = 0; y < OctahedralGridSize; ++y)
+		{
+			for (uint32_t x = 0; x < OctahedralGridSize; ++x)
+			{
+				float u = ((float)x + 0.5f) / (float)OctahedralGridSize * 2.f - 1.f;
+				float v = ((float)y + 0.5f) / (float)OctahedralGridSize * 2.f - 1.f;
+				vec3 dir;
+
+				if (layout == IMPOSTER_VIEW_LAYOUT_HEMI_OCTAHEDRAL)
+				{
+					float hx = (u + v) * 0.5f;
+					float hz = (u - v) * 0.5f;
+					dir = vec3(hx, 1.f - fabsf(hx) - fabsf(hz), hz);
+				}
+				else
+				{
+					dir = vec3(u, 1.f - fabsf(u) - fabsf(v), v);
+					if (dir.getY() < 0.f)
+						dir = vec3((1.f - fabsf(v)) * (u >= 0.f ? 1.f : -1.f), dir.getY(), (1.f - fabsf(u)) * (v >= 0.f ? 1.f : -1.f));
+				}
+				dir = normalize(dir);
+
+				//Straight up or down views need another up vector.
+				vec3 up = fabsf(dir.getY()) > 0.99f ? vec3(0.f, 0.f, 1.f) : vec3(0.f, 1.f, 0.f);
+
+				uint32_t index = y * OctahedralGridSize + x;
+				imposterRotationMatrices[index] = mat4::identity();
+				imposterCaptureViewMats[index] = mat4::lookAtLH(Point3(center + dir * distance), Point3(center), up);
+			}
+		}
+	}
+
+	void ApplyImposterViewLayout(uint32_t layout)
+	{
+		//View count changes the atlas slice count, rebuild it and everything bound to it.
+		DrainQueues();
+
+		gImposterViewLayout = layout;
+		RemoveImposterAtlas(&gImposterAtlas);
+		gImposterAtlasDesc.mViewCount = GetImposterViewCount(layout);
+		AddImposterAtlas(&gImposterAtlasDesc, &gImposterAtlas);
+
+		BuildImposterViews(layout);
+		pBufferImposterViewMats->UpdateData(imposterCaptureViewMats);
+
+		//Every slice is new, the scheduler starts over.
+		gCaptureScheduler.mRoundRobinCursor = 0;
+		memset(gCaptureScheduler.mLastCaptureStamp, 0, sizeof(gCaptureScheduler.mLastCaptureStamp));
+
+		waitForAllResourceLoads();
+		PrepareDescriptorSets();
+	}
+
+	void InitCameraControllers()
+	{
+		CameraMotionParameters cmp{ 50.0f, 75.0f, 150.0f, 0.5f, 0.5f };
+
+		vec3 lookAt{ 0.f, 0.f, -1.f };
+
+		//Capture aspect follows the atlas view size, not the window.
+		const float aspectInverse = (float)gImposterAtlas.mViewHeight / (float)gImposterAtlas.mViewWidth;
+		const float horizontal_fov = PI / 2.f;
+
+		const float zNear = 0.1f;
+		const float zFar = 50.f;
+
+		CameraMatrix projMat = CameraMatrix::perspectiveReverseZ(horizontal_fov, aspectInverse, zNear, zFar);
+
+		//Camera for billboard capturing.
+		billboardCamera = initFpsCameraController({ 0.f, 4.f, 5.3f }, lookAt);
+		billboardCamera->setMotionParameters(cmp);
+		billboardCamera->setViewRotationXY({ 0.34f, 3.14f });
+
+		mat4 viewMat = billboardCamera->getViewMatrix();
+
+		imposterProjMatrix = projMat.getPrimaryMatrix();
+		imposterViewMatrix = viewMat;
+
+		//Setting imposter matrices
+		BuildImposterViews(gImposterViewLayout);
+
+		vec3 camPos{ -3.0f, 3.0f, 5.0f };
+		lookAt = { 0.0f, 1.0f, 0.0f };
+
+		mainCamera = initFpsCameraController(camPos, lookAt);
+		mainCamera->setMotionParameters(cmp);
+
+		secondCamera = initFpsCameraController(camPos, lookAt);
+		secondCamera->setMotionParameters(cmp);
+
+		light = initFpsCameraController({ 0.f, 0.f, 0.f }, {});
+	}
+
+	
+	////////////////////////////////////////////////////////////////////////////////////
+	//										Load Funcs								  //
+	////////////////////////////////////////////////////////////////////////////////////
+	void AddShaders()
+	{
+		//Setup shaders.
+		gBonePaletteFormat = gUIData.mGeneralSettings.bonePaletteFormat;
+		gBonePaletteReloadRequested = false;
+
+		ShaderLoadDesc planeShader{};
+		planeShader.mStages[0].pFileName = "plane.vert";
+		planeShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		planeShader.mStages[1].pFileName = "plane.frag";
 		planeShader.mStages[1].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
 
 		ShaderLoadDesc skinningShader{};
-		skinningShader.mStages[0].pFileName = "skinning.vert";
+		skinningShader.mStages[0].pFileName = gSkinningVertShaders[gBonePaletteFormat];
 		skinningShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
 		skinningShader.mStages[1].pFileName = "skinning.frag";
 		skinningShader.mStages[1].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
@@ -1602,13 +4305,62 @@ class ImposterRendering: public IApp
 		angleShaderDesc.mStages[0].pFileName = "BillboardQuadAngleCompute.comp";
 
 		ShaderLoadDesc animAccelShaderDesc{};
-		animAccelShaderDesc.mStages[0].pFileName = "AnimationAccelerator.comp";
+		animAccelShaderDesc.mStages[0].pFileName = gAnimAccelCompShaders[gBonePaletteFormat];
+
+		ShaderLoadDesc skinningComputeShaderDesc{};
+		skinningComputeShaderDesc.mStages[0].pFileName = gSkinningCompShaders[gBonePaletteFormat];
+
+		ShaderLoadDesc posedMeshShader{};
+		posedMeshShader.mStages[0].pFileName = "posedMesh.vert";
+		posedMeshShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		posedMeshShader.mStages[1].pFileName = "skinning.frag";
+		posedMeshShader.mStages[1].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+
+		ShaderLoadDesc posedMeshMultiViewShader{};
+		posedMeshMultiViewShader.mStages[0].pFileName = "posedMeshMultiView.vert";
+		posedMeshMultiViewShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		posedMeshMultiViewShader.mStages[1].pFileName = "skinning.frag";
+		posedMeshMultiViewShader.mStages[1].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
 
 		addShader(renderer, &planeShader, &pShaderPlane);
 		addShader(renderer, &skinningShader, &pShaderSkinning);
 		addShader(renderer, &quadShader, &pShaderQuad);
 		addShader(renderer, &angleShaderDesc, &pShaderAngleCompute);
 		addShader(renderer, &animAccelShaderDesc, &pShaderAnimAccelerator);
+		addShader(renderer, &skinningComputeShaderDesc, &pShaderSkinningCompute);
+		addShader(renderer, &posedMeshShader, &pShaderPosedMesh);
+		if (gMultiViewCaptureSupported)
+			addShader(renderer, &posedMeshMultiViewShader, &pShaderPosedMeshMultiView);
+
+		ShaderLoadDesc hizBuildShaderDesc{};
+		hizBuildShaderDesc.mStages[0].pFileName = "HiZBuild.comp";
+		addShader(renderer, &hizBuildShaderDesc, &pShaderHiZBuild);
+
+		ShaderLoadDesc occlusionRetestShaderDesc{};
+		occlusionRetestShaderDesc.mStages[0].pFileName = "BillboardOcclusionRetest.comp";
+		addShader(renderer, &occlusionRetestShaderDesc, &pShaderOcclusionRetest);
+
+		ShaderLoadDesc clusterCullShaderDesc{};
+		clusterCullShaderDesc.mStages[0].pFileName = "ImposterClusterCull.comp";
+		addShader(renderer, &clusterCullShaderDesc, &pShaderClusterCull);
+
+		ShaderLoadDesc nearFieldPaletteShaderDesc{};
+		nearFieldPaletteShaderDesc.mStages[0].pFileName = gNearFieldPaletteCompShaders[gBonePaletteFormat];
+		addShader(renderer, &nearFieldPaletteShaderDesc, &pShaderNearFieldPalette);
+
+		ShaderLoadDesc skinningInstancedShader{};
+		skinningInstancedShader.mStages[0].pFileName = gSkinningInstancedVertShaders[gBonePaletteFormat];
+		skinningInstancedShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		skinningInstancedShader.mStages[1].pFileName = "skinning.frag";
+		skinningInstancedShader.mStages[1].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		addShader(renderer, &skinningInstancedShader, &pShaderSkinningInstanced);
+
+		ShaderLoadDesc vatMeshShader{};
+		vatMeshShader.mStages[0].pFileName = "vatMesh.vert";
+		vatMeshShader.mStages[0].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		vatMeshShader.mStages[1].pFileName = "skinning.frag";
+		vatMeshShader.mStages[1].mFlags = SHADER_STAGE_LOAD_FLAG_NONE;
+		addShader(renderer, &vatMeshShader, &pShaderVatMesh);
 	}
 
 	bool AddSwapChain()
@@ -1633,24 +4385,64 @@ class ImposterRendering: public IApp
 	{
 		//Setup descriptorSets.
 		DescriptorSetDesc
-			setDesc = { pRootSignaturePlane, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, gDataBufferCount };
+			setDesc = { pRootSignaturePlane, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorSet);
 
 		setDesc = { pRootSignatureSkinning, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorSetSkinning[0]);
-		setDesc = { pRootSignatureSkinning, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, gDataBufferCount };
+		setDesc = { pRootSignatureSkinning, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorSetSkinning[1]);
 
-		setDesc = { pRootSignatureQuad, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, gDataBufferCount };
+		setDesc = { pRootSignatureQuad, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorQuad);
+		setDesc = { pRootSignatureQuad, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetImposterHeap);
 
-		setDesc = { pRootSigCompAngleCompute, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, 2 };
+		setDesc = { pRootSigCompAngleCompute, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorSetCompAngleCompute);
 
 		setDesc = { pRootSigAnimAccelerator, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorSetAnimAccelerator[0]);
-		setDesc = { pRootSigAnimAccelerator, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, 2 };
+		setDesc = { pRootSigAnimAccelerator, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
 		addDescriptorSet(renderer, &setDesc, &pDescriptorSetAnimAccelerator[1]);
+
+		setDesc = { pRootSigSkinningCompute, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetSkinningCompute);
+
+		setDesc = { pRootSignaturePosedMesh, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetPosedMesh);
+
+		if (gMultiViewCaptureSupported)
+		{
+			setDesc = { pRootSignaturePosedMeshMultiView, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
+			addDescriptorSet(renderer, &setDesc, &pDescriptorSetPosedMeshMultiView[0]);
+			setDesc = { pRootSignaturePosedMeshMultiView, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+			addDescriptorSet(renderer, &setDesc, &pDescriptorSetPosedMeshMultiView[1]);
+		}
+
+		setDesc = { pRootSigHiZBuild, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxHiZMipCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetHiZBuild);
+
+		setDesc = { pRootSigOcclusionRetest, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetOcclusionRetest);
+
+		setDesc = { pRootSigClusterCull, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetClusterCull);
+
+		setDesc = { pRootSigNearFieldPalette, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetNearFieldPalette[0]);
+		setDesc = { pRootSigNearFieldPalette, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetNearFieldPalette[1]);
+
+		setDesc = { pRootSignatureSkinningInstanced, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetSkinningInstanced[0]);
+		setDesc = { pRootSignatureSkinningInstanced, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetSkinningInstanced[1]);
+
+		setDesc = { pRootSignatureVatMesh, DESCRIPTOR_UPDATE_FREQ_NONE, 1 };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetVatMesh[0]);
+		setDesc = { pRootSignatureVatMesh, DESCRIPTOR_UPDATE_FREQ_PER_DRAW, MaxDataBufferCount };
+		addDescriptorSet(renderer, &setDesc, &pDescriptorSetVatMesh[1]);
 	}
 
 	void AddRootSignatures()
@@ -1670,14 +4462,46 @@ class ImposterRendering: public IApp
 		rootDesc.ppStaticSamplers = &pDefaultSampler;
 		addRootSignature(renderer, &rootDesc, &pRootSignatureSkinning);
 
+		//The imposter heap is bindless, new archetypes change nothing here.
 		rootDesc.ppShaders = &pShaderQuad;
 		rootDesc.ppStaticSamplers = &pDefaultSampler;
+		rootDesc.mMaxBindlessTextures = ImposterTextureHeapSize;
 		addRootSignature(renderer, &rootDesc, &pRootSignatureQuad);
+		rootDesc.mMaxBindlessTextures = 0;
+
+		rootDesc.ppShaders = &pShaderPosedMesh;
+		rootDesc.ppStaticSamplers = &pDefaultSampler;
+		addRootSignature(renderer, &rootDesc, &pRootSignaturePosedMesh);
+
+		if (gMultiViewCaptureSupported)
+		{
+			rootDesc.ppShaders = &pShaderPosedMeshMultiView;
+			rootDesc.ppStaticSamplers = &pDefaultSampler;
+			addRootSignature(renderer, &rootDesc, &pRootSignaturePosedMeshMultiView);
+		}
+
+		rootDesc.ppShaders = &pShaderSkinningInstanced;
+		rootDesc.ppStaticSamplers = &pDefaultSampler;
+		addRootSignature(renderer, &rootDesc, &pRootSignatureSkinningInstanced);
+
+		rootDesc.ppShaders = &pShaderVatMesh;
+		rootDesc.ppStaticSamplers = &pDefaultSampler;
+		addRootSignature(renderer, &rootDesc, &pRootSignatureVatMesh);
 
 		RootSignatureDesc computeRootDesc = { &pShaderAngleCompute, 1 };
 		addRootSignature(renderer, &computeRootDesc, &pRootSigCompAngleCompute);
 		computeRootDesc = { &pShaderAnimAccelerator, 1 };
 		addRootSignature(renderer, &computeRootDesc, &pRootSigAnimAccelerator);
+		computeRootDesc = { &pShaderSkinningCompute, 1 };
+		addRootSignature(renderer, &computeRootDesc, &pRootSigSkinningCompute);
+		computeRootDesc = { &pShaderHiZBuild, 1 };
+		addRootSignature(renderer, &computeRootDesc, &pRootSigHiZBuild);
+		computeRootDesc = { &pShaderOcclusionRetest, 1 };
+		addRootSignature(renderer, &computeRootDesc, &pRootSigOcclusionRetest);
+		computeRootDesc = { &pShaderClusterCull, 1 };
+		addRootSignature(renderer, &computeRootDesc, &pRootSigClusterCull);
+		computeRootDesc = { &pShaderNearFieldPalette, 1 };
+		addRootSignature(renderer, &computeRootDesc, &pRootSigNearFieldPalette);
 	}
 
 	void AddPipelines()
@@ -1784,6 +4608,52 @@ class ImposterRendering: public IApp
 		pipelineSettings.pRasterizerState = &skeletonRasterizerStateDesc;
 		addPipeline(renderer, &desc, &pPipelineSkinning);
 
+		pipelineSettings.pRootSignature = pRootSignatureSkinningInstanced;
+		pipelineSettings.pShaderProgram = pShaderSkinningInstanced;
+		addPipeline(renderer, &desc, &pPipelineSkinningInstanced);
+
+		//Positions, normals and uvs all come from the animation buffer, only the index buffer is bound.
+		pipelineSettings.pRootSignature = pRootSignatureVatMesh;
+		pipelineSettings.pShaderProgram = pShaderVatMesh;
+		pipelineSettings.pVertexLayout = NULL;
+		addPipeline(renderer, &desc, &pPipelineVatMesh);
+
+		VertexLayout posedVertexLayout{};
+		posedVertexLayout.mBindingCount = 1;
+		posedVertexLayout.mAttribCount = 3;
+		posedVertexLayout.mAttribs[0].mSemantic = SEMANTIC_POSITION;
+		posedVertexLayout.mAttribs[0].mFormat = TinyImageFormat_R32G32B32_SFLOAT;
+		posedVertexLayout.mAttribs[0].mBinding = 0;
+		posedVertexLayout.mAttribs[0].mLocation = 0;
+		posedVertexLayout.mAttribs[0].mOffset = 0;
+		posedVertexLayout.mAttribs[1].mSemantic = SEMANTIC_NORMAL;
+		posedVertexLayout.mAttribs[1].mFormat = TinyImageFormat_R32G32B32_SFLOAT;
+		posedVertexLayout.mAttribs[1].mBinding = 0;
+		posedVertexLayout.mAttribs[1].mLocation = 1;
+		posedVertexLayout.mAttribs[1].mOffset = 3 * sizeof(float);
+		posedVertexLayout.mAttribs[2].mSemantic = SEMANTIC_TEXCOORD0;
+		posedVertexLayout.mAttribs[2].mFormat = TinyImageFormat_R32G32_SFLOAT;
+		posedVertexLayout.mAttribs[2].mBinding = 0;
+		posedVertexLayout.mAttribs[2].mLocation = 2;
+		posedVertexLayout.mAttribs[2].mOffset = 6 * sizeof(float);
+
+		pipelineSettings.pRootSignature = pRootSignaturePosedMesh;
+		pipelineSettings.pShaderProgram = pShaderPosedMesh;
+		pipelineSettings.pVertexLayout = &posedVertexLayout;
+		addPipeline(renderer, &desc, &pPipelinePosedMesh);
+
+		//Layered capture, the vertex shader routes each instance to its atlas slice.
+		if (gMultiViewCaptureSupported)
+		{
+			pipelineSettings.pColorFormats = &gImposterAtlas.pColor->mFormat;
+			pipelineSettings.mSampleCount = gImposterAtlas.pColor->mSampleCount;
+			pipelineSettings.mSampleQuality = gImposterAtlas.pColor->mSampleQuality;
+			pipelineSettings.mDepthStencilFormat = gImposterAtlas.pDepth->mFormat;
+			pipelineSettings.pRootSignature = pRootSignaturePosedMeshMultiView;
+			pipelineSettings.pShaderProgram = pShaderPosedMeshMultiView;
+			addPipeline(renderer, &desc, &pPipelinePosedMeshMultiView);
+		}
+
 		vertexLayout = {};
 		vertexLayout.mBindingCount = 1;
 		vertexLayout.mAttribCount = 2;
@@ -1815,6 +4685,14 @@ class ImposterRendering: public IApp
 		pipelineSettings.pRasterizerState = &quadRasterizerStateDesc;
 		addPipeline(renderer, &desc, &pPipelineQuad);
 
+		//Shadow casters only write depth, the pixel shader is kept for its alpha test.
+		pipelineSettings.mRenderTargetCount = 0;
+		pipelineSettings.pColorFormats = NULL;
+		pipelineSettings.mSampleCount = shadowDepthRT->mSampleCount;
+		pipelineSettings.mSampleQuality = shadowDepthRT->mSampleQuality;
+		pipelineSettings.mDepthStencilFormat = shadowDepthRT->mFormat;
+		addPipeline(renderer, &desc, &pPipelineQuadShadow);
+
 		PipelineDesc computeDesc = {};
 		computeDesc.mType = PIPELINE_TYPE_COMPUTE;
 		ComputePipelineDesc& cPipelineSettings = computeDesc.mComputeDesc;
@@ -1825,37 +4703,100 @@ class ImposterRendering: public IApp
 		cPipelineSettings.pShaderProgram = pShaderAnimAccelerator;
 		cPipelineSettings.pRootSignature = pRootSigAnimAccelerator;
 		addPipeline(renderer, &computeDesc, &pPipelineAnimAccelerator);
+		cPipelineSettings.pShaderProgram = pShaderSkinningCompute;
+		cPipelineSettings.pRootSignature = pRootSigSkinningCompute;
+		addPipeline(renderer, &computeDesc, &pPipelineSkinningCompute);
+		cPipelineSettings.pShaderProgram = pShaderHiZBuild;
+		cPipelineSettings.pRootSignature = pRootSigHiZBuild;
+		addPipeline(renderer, &computeDesc, &pPipelineHiZBuild);
+		cPipelineSettings.pShaderProgram = pShaderOcclusionRetest;
+		cPipelineSettings.pRootSignature = pRootSigOcclusionRetest;
+		addPipeline(renderer, &computeDesc, &pPipelineOcclusionRetest);
+		cPipelineSettings.pShaderProgram = pShaderClusterCull;
+		cPipelineSettings.pRootSignature = pRootSigClusterCull;
+		addPipeline(renderer, &computeDesc, &pPipelineClusterCull);
+		cPipelineSettings.pShaderProgram = pShaderNearFieldPalette;
+		cPipelineSettings.pRootSignature = pRootSigNearFieldPalette;
+		addPipeline(renderer, &computeDesc, &pPipelineNearFieldPalette);
+
+		IndirectArgumentDescriptor quadIndirectArg = {};
+		quadIndirectArg.mType = INDIRECT_DRAW;
+
+		CommandSignatureDesc quadCmdSignatureDesc = {};
+		quadCmdSignatureDesc.pRootSignature = pRootSignatureQuad;
+		quadCmdSignatureDesc.mIndirectArgCount = 1;
+		quadCmdSignatureDesc.pArgDescs = &quadIndirectArg;
+		quadCmdSignatureDesc.mPacked = true;
+		addIndirectCommandSignature(renderer, &quadCmdSignatureDesc, &pCmdSignatureQuad);
+
+		IndirectArgumentDescriptor clusterDispatchArg = {};
+		clusterDispatchArg.mType = INDIRECT_DISPATCH;
+
+		CommandSignatureDesc clusterDispatchSignatureDesc = {};
+		clusterDispatchSignatureDesc.pRootSignature = pRootSigCompAngleCompute;
+		clusterDispatchSignatureDesc.mIndirectArgCount = 1;
+		clusterDispatchSignatureDesc.pArgDescs = &clusterDispatchArg;
+		clusterDispatchSignatureDesc.mPacked = true;
+		addIndirectCommandSignature(renderer, &clusterDispatchSignatureDesc, &pCmdSignatureClusterDispatch);
+
+		clusterDispatchSignatureDesc.pRootSignature = pRootSigOcclusionRetest;
+		addIndirectCommandSignature(renderer, &clusterDispatchSignatureDesc, &pCmdSignatureRetestDispatch);
+
+		IndirectArgumentDescriptor nearFieldDrawArg = {};
+		nearFieldDrawArg.mType = INDIRECT_DRAW_INDEX;
+
+		CommandSignatureDesc nearFieldSignatureDesc = {};
+		nearFieldSignatureDesc.pRootSignature = pRootSignatureSkinningInstanced;
+		nearFieldSignatureDesc.mIndirectArgCount = 1;
+		nearFieldSignatureDesc.pArgDescs = &nearFieldDrawArg;
+		nearFieldSignatureDesc.mPacked = true;
+		addIndirectCommandSignature(renderer, &nearFieldSignatureDesc, &pCmdSignatureNearField);
+
+		nearFieldSignatureDesc.pRootSignature = pRootSignatureVatMesh;
+		addIndirectCommandSignature(renderer, &nearFieldSignatureDesc, &pCmdSignatureVat);
 	}
 
-	void AddRenderTargets()
+	void AddImposterAtlas(const ImposterAtlasDesc* pDesc, ImposterAtlas* pAtlas)
 	{
-		//Add render targets & initialize rtTextures[].
-		RenderTargetDesc rtsDescription{};
-		rtsDescription.mArraySize = 1;
-		rtsDescription.mClearValue = { 0.f, 0.f, 0.f, 0.f };
-		rtsDescription.mDepth = 1;
-		rtsDescription.mDescriptors = DESCRIPTOR_TYPE_TEXTURE;
-		rtsDescription.mWidth = mSettings.mWidth;
-		rtsDescription.mHeight = mSettings.mHeight;
-		rtsDescription.mSampleCount = SAMPLE_COUNT_1;
-		rtsDescription.mSampleQuality = 0;
-		rtsDescription.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
-		rtsDescription.mFormat = getRecommendedSwapchainFormat(true, true);
-		rtsDescription.mFlags = TEXTURE_CREATION_FLAG_OWN_MEMORY_BIT;
-		rtsDescription.pName = "Render Targets";
-
-		for (int i = 0; i < TextureCount; ++i)
-		{
-			addRenderTarget(renderer, &rtsDescription, &rts[i]);
-			rtTextures[i] = rts[i]->pTexture;
-		}
-
-		//Add Shadow RT.
-		rtsDescription.mDescriptors = DESCRIPTOR_TYPE_TEXTURE;
-		rtsDescription.mStartState = RESOURCE_STATE_RENDER_TARGET;
-		rtsDescription.pName = "Shadow Render Target";
-		addRenderTarget(renderer, &rtsDescription, &shadowRT);
+		//One texture array holds every view, sized per imposter type.
+		pAtlas->mViewWidth = pDesc->mViewWidth;
+		pAtlas->mViewHeight = pDesc->mViewHeight;
+		pAtlas->mViewCount = pDesc->mViewCount;
+
+		RenderTargetDesc atlasDesc{};
+		atlasDesc.mArraySize = pDesc->mViewCount;
+		atlasDesc.mClearValue = { 0.f, 0.f, 0.f, 0.f };
+		atlasDesc.mDepth = 1;
+		atlasDesc.mDescriptors = DESCRIPTOR_TYPE_TEXTURE | DESCRIPTOR_TYPE_RENDER_TARGET_ARRAY_SLICES;
+		atlasDesc.mWidth = pDesc->mViewWidth;
+		atlasDesc.mHeight = pDesc->mViewHeight;
+		atlasDesc.mSampleCount = SAMPLE_COUNT_1;
+		atlasDesc.mSampleQuality = 0;
+		atlasDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		atlasDesc.mFormat = getRecommendedSwapchainFormat(true, true);
+		atlasDesc.mFlags = TEXTURE_CREATION_FLAG_OWN_MEMORY_BIT;
+		atlasDesc.pName = "Imposter Atlas";
+		addRenderTarget(renderer, &atlasDesc, &pAtlas->pColor);
+
+		//Depth slice per view, single pass capture writes every view at once.
+		RenderTargetDesc atlasDepthDesc{};
+		atlasDepthDesc.mArraySize = pDesc->mViewCount;
+		atlasDepthDesc.mClearValue.depth = 0.f;
+		atlasDepthDesc.mClearValue.stencil = 0;
+		atlasDepthDesc.mDepth = 1;
+		atlasDepthDesc.mDescriptors = DESCRIPTOR_TYPE_RENDER_TARGET_ARRAY_SLICES;
+		atlasDepthDesc.mFormat = TinyImageFormat_D32_SFLOAT;
+		atlasDepthDesc.mStartState = RESOURCE_STATE_DEPTH_WRITE;
+		atlasDepthDesc.mWidth = pDesc->mViewWidth;
+		atlasDepthDesc.mHeight = pDesc->mViewHeight;
+		atlasDepthDesc.mSampleCount = SAMPLE_COUNT_1;
+		atlasDepthDesc.mSampleQuality = 0;
+		atlasDepthDesc.pName = "Imposter Atlas Depth";
+		addRenderTarget(renderer, &atlasDepthDesc, &pAtlas->pDepth);
+	}
 
+	void AddRenderTargets()
+	{
 		//Add Shadow Depth RT.
 		RenderTargetDesc depthRT{};
 		depthRT.mArraySize = 1;
@@ -1871,26 +4812,77 @@ class ImposterRendering: public IApp
 		depthRT.mFlags = TEXTURE_CREATION_FLAG_ON_TILE | TEXTURE_CREATION_FLAG_VR_MULTIVIEW;
 		addRenderTarget(renderer, &depthRT, &shadowDepthRT);
 
-		//Add depth.
+		//Add depth, sampled by the HiZ build.
 		depthRT.mStartState = RESOURCE_STATE_DEPTH_WRITE;
+		depthRT.mDescriptors = DESCRIPTOR_TYPE_TEXTURE;
+		depthRT.mFlags = TEXTURE_CREATION_FLAG_NONE;
+		depthRT.pName = "Depth Buffer";
 		addRenderTarget(renderer, &depthRT, &pDepthBuffer);
+
+		//HiZ pyramid, full mip chain of the depth buffer.
+		gHiZMipCount = 1;
+		while (gHiZMipCount < MaxHiZMipCount && (max(mSettings.mWidth, mSettings.mHeight) >> gHiZMipCount) > 0)
+			++gHiZMipCount;
+
+		TextureDesc hizDesc{};
+		hizDesc.mArraySize = 1;
+		hizDesc.mDepth = 1;
+		hizDesc.mWidth = mSettings.mWidth;
+		hizDesc.mHeight = mSettings.mHeight;
+		hizDesc.mMipLevels = gHiZMipCount;
+		hizDesc.mSampleCount = SAMPLE_COUNT_1;
+		hizDesc.mFormat = TinyImageFormat_R32_SFLOAT;
+		hizDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		hizDesc.mDescriptors = DESCRIPTOR_TYPE_TEXTURE | DESCRIPTOR_TYPE_RW_TEXTURE;
+		hizDesc.mFlags = TEXTURE_CREATION_FLAG_OWN_MEMORY_BIT;
+		hizDesc.pName = "HiZ";
+
+		TextureLoadDesc hizLoadDesc{};
+		hizLoadDesc.pDesc = &hizDesc;
+		hizLoadDesc.ppTexture = &pTextureHiZ;
+		addResource(&hizLoadDesc, NULL);
+		waitForAllResourceLoads();
+
+		//Pyramid content is gone, first frame after a resize skips occlusion.
+		gHiZValid = false;
 	}
 
 
 	void PrepareDescriptorSets()
 	{
 		//Prepare descriptor setups.
-		DescriptorData params[6] = {};
+		DescriptorData params[23] = {};
 		params[0].pName = "DiffuseTexture";
 		params[0].ppTextures = &pTextureDiffuse;
 
 		updateDescriptorSet(renderer, 0, pDescriptorSetSkinning[0], 1, params);
+		updateDescriptorSet(renderer, 0, pDescriptorSetPosedMesh, 1, params);
+		updateDescriptorSet(renderer, 0, pDescriptorSetSkinningInstanced[0], 1, params);
+		updateDescriptorSet(renderer, 0, pDescriptorSetVatMesh[0], 1, params);
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		if (gMultiViewCaptureSupported)
+		{
+			params[1] = {};
+			params[1].pName = "captureViewMats";
+			params[1].ppBuffers = &pBufferImposterViewMats->buffer;
+			updateDescriptorSet(renderer, 0, pDescriptorSetPosedMeshMultiView[0], 2, params);
+
+			for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+			{
+				params[0] = {};
+				params[0].pName = "captureViewList";
+				params[0].ppBuffers = &pBufferCaptureViewList[i]->buffer;
+				updateDescriptorSet(renderer, i, pDescriptorSetPosedMeshMultiView[1], 1, params);
+			}
+		}
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
+			DescriptorDataRange cameraRange = GetUploadRange(gUploadCamera, i);
 			params[0] = {};
 			params[0].pName = "transformBlock";
-			params[0].ppBuffers = &pBufferPlaneTransformations[i]->buffer;
+			params[0].ppBuffers = &gUploadRing.pBuffer;
+			params[0].pRanges = &cameraRange;
 
 			params[1] = {};
 			params[1].pName = "DepthMap";
@@ -1899,19 +4891,22 @@ class ImposterRendering: public IApp
 			updateDescriptorSet(renderer, i, pDescriptorSet, 2, params);
 		}
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
 			params[0] = {};
 			params[0].pName = "boneMatrices";
-			params[0].ppBuffers = &pBufferBoneTransformations[i]->buffer;
+			params[0].ppBuffers = &pBufferBonePalette[i]->buffer;
 			updateDescriptorSet(renderer, i, pDescriptorSetSkinning[1], 1, params);
 		}
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
+			//Same camera block as the plane, the quad shader only reads its first two matrices.
+			DescriptorDataRange cameraRange = GetUploadRange(gUploadCamera, i);
 			params[0] = {};
 			params[0].pName = "transformBlock";
-			params[0].ppBuffers = &pBufferQuadTransformations[i]->buffer;
+			params[0].ppBuffers = &gUploadRing.pBuffer;
+			params[0].pRanges = &cameraRange;
 
 			params[1] = {};
 			params[1].pName = "billboardPositions";
@@ -1922,19 +4917,39 @@ class ImposterRendering: public IApp
 			params[2].ppBuffers = &pBufferQuadAngles[i]->buffer;
 
 			params[3] = {};
-			params[3].pName = "textures";
-			params[3].ppTextures = rtTextures;
-			params[3].mCount = TextureCount;
+			params[3].pName = "billboardArchetypes";
+			params[3].ppBuffers = &pBufferQuadArchetypes->buffer;
 
 			params[4] = {};
 			params[4].pName = "shadowMatBlock";
 			params[4].ppBuffers = &pBufferShadowTransformations->buffer;
 
-			updateDescriptorSet(renderer, i, pDescriptorQuad, 5, params);
+			params[5] = {};
+			params[5].pName = "billboardPhases";
+			params[5].ppBuffers = &pBufferQuadPhases->buffer;
+
+			params[6] = {};
+			params[6].pName = "visibleIndices";
+			params[6].ppBuffers = &pBufferVisibleIndices[i]->buffer;
+
+			params[7] = {};
+			params[7].pName = "retestIndices";
+			params[7].ppBuffers = &pBufferRetestIndices[i]->buffer;
+
+			params[8] = {};
+			params[8].pName = "shadowIndices";
+			params[8].ppBuffers = &pBufferShadowIndices[i]->buffer;
+
+			updateDescriptorSet(renderer, i, pDescriptorQuad, 9, params);
 		}
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		UpdateImposterTextureHeap();
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
+			DescriptorDataRange frustumRange = GetUploadRange(gUploadFrustum, i);
+			DescriptorDataRange occlusionRange = GetUploadRange(gUploadOcclusion, i);
+
 			params[0] = {};
 			params[0].pName = "billboardPositions";
 			params[0].ppBuffers = &pBufferQuadsPosition->buffer;
@@ -1950,36 +4965,353 @@ class ImposterRendering: public IApp
 			//Frustum block
 			params[3] = {};
 			params[3].pName = "frustumBlock";
-			params[3].ppBuffers = &pBufferFrustumPlanes->buffer;
+			params[3].ppBuffers = &gUploadRing.pBuffer;
+			params[3].pRanges = &frustumRange;
+
+			params[4] = {};
+			params[4].pName = "angleBinUsage";
+			params[4].ppBuffers = &pBufferAngleBinUsage->buffer;
+
+			params[5] = {};
+			params[5].pName = "visibleIndices";
+			params[5].ppBuffers = &pBufferVisibleIndices[i]->buffer;
+
+			params[6] = {};
+			params[6].pName = "quadIndirectArgs";
+			params[6].ppBuffers = &pBufferQuadIndirectArgs[i]->buffer;
+
+			params[7] = {};
+			params[7].pName = "hizTexture";
+			params[7].ppTextures = &pTextureHiZ;
+
+			params[8] = {};
+			params[8].pName = "occlusionBlock";
+			params[8].ppBuffers = &gUploadRing.pBuffer;
+			params[8].pRanges = &occlusionRange;
+
+			params[9] = {};
+			params[9].pName = "occlusionCandidates";
+			params[9].ppBuffers = &pBufferOcclusionCandidates[i]->buffer;
+
+			params[10] = {};
+			params[10].pName = "occlusionCounters";
+			params[10].ppBuffers = &pBufferOcclusionCounters[i]->buffer;
+
+			params[11] = {};
+			params[11].pName = "imposterClusters";
+			params[11].ppBuffers = &pBufferImposterClusters->buffer;
+
+			params[12] = {};
+			params[12].pName = "visibleClusters";
+			params[12].ppBuffers = &pBufferVisibleClusters[i]->buffer;
+
+			params[13] = {};
+			params[13].pName = "nearFieldIndices";
+			params[13].ppBuffers = &pBufferNearFieldIndices[i]->buffer;
+
+			params[14] = {};
+			params[14].pName = "nearFieldArgs";
+			params[14].ppBuffers = &pBufferNearFieldArgs[i]->buffer;
+
+			params[15] = {};
+			params[15].pName = "vatIndices";
+			params[15].ppBuffers = &pBufferVatIndices[i]->buffer;
+
+			params[16] = {};
+			params[16].pName = "vatArgs";
+			params[16].ppBuffers = &pBufferVatArgs[i]->buffer;
+
+			params[17] = {};
+			params[17].pName = "retestDispatchArgs";
+			params[17].ppBuffers = &pBufferRetestDispatchArgs[i]->buffer;
+
+			params[18] = {};
+			params[18].pName = "nearFieldHistogram";
+			params[18].ppBuffers = &pBufferNearFieldHistogram[i]->buffer;
+
+			params[19] = {};
+			params[19].pName = "billboardArchetypes";
+			params[19].ppBuffers = &pBufferQuadArchetypes->buffer;
+
+			params[20] = {};
+			params[20].pName = "imposterHeapLayouts";
+			params[20].ppBuffers = &pBufferImposterHeapLayouts->buffer;
+
+			params[21] = {};
+			params[21].pName = "shadowIndices";
+			params[21].ppBuffers = &pBufferShadowIndices[i]->buffer;
+
+			params[22] = {};
+			params[22].pName = "shadowIndirectArgs";
+			params[22].ppBuffers = &pBufferShadowIndirectArgs[i]->buffer;
 
-			updateDescriptorSet(renderer, i, pDescriptorSetCompAngleCompute, 4, params);
+			updateDescriptorSet(renderer, i, pDescriptorSetCompAngleCompute, 23, params);
 		}
 
 		params[0] = {};
-		params[0].pName = "jointParentSlots";
-		params[0].ppBuffers = &pBufferJointParentsIndex->buffer;
-		updateDescriptorSet(renderer, 0, pDescriptorSetAnimAccelerator[0], 1, params);
+		params[0].pName = "poseRotations";
+		params[0].ppBuffers = &pBufferPoseRotations->buffer;
+		params[1] = {};
+		params[1].pName = "jointRemaps";
+		params[1].ppBuffers = &pBufferJointRemaps->buffer;
+		params[2] = {};
+		params[2].pName = "inverseBindPoses";
+		params[2].ppBuffers = &pBufferInverseBindPoses->buffer;
+		params[3] = {};
+		params[3].pName = "billboardPositions";
+		params[3].ppBuffers = &pBufferQuadsPosition->buffer;
+		params[4] = {};
+		params[4].pName = "billboardPhases";
+		params[4].ppBuffers = &pBufferQuadPhases->buffer;
+		params[5] = {};
+		params[5].pName = "poseTranslations";
+		params[5].ppBuffers = &pBufferPoseTranslations->buffer;
+		params[6] = {};
+		params[6].pName = "poseScales";
+		params[6].ppBuffers = &pBufferPoseScales->buffer;
+		params[7] = {};
+		params[7].pName = "jointParentSlots";
+		params[7].ppBuffers = &pBufferJointParentsIndex->buffer;
+		params[8] = {};
+		params[8].pName = "jointLevelOrder";
+		params[8].ppBuffers = &pBufferJointLevelOrder->buffer;
+		params[9] = {};
+		params[9].pName = "jointLevelRanges";
+		params[9].ppBuffers = &pBufferJointLevelRanges->buffer;
+		params[10] = {};
+		params[10].pName = "billboardDirections";
+		params[10].ppBuffers = &pBufferQuadDirection->buffer;
+		updateDescriptorSet(renderer, 0, pDescriptorSetNearFieldPalette[0], 11, params);
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			params[0] = {};
+			params[0].pName = "nearFieldIndices";
+			params[0].ppBuffers = &pBufferNearFieldIndices[i]->buffer;
+			params[1] = {};
+			params[1].pName = "nearFieldArgs";
+			params[1].ppBuffers = &pBufferNearFieldArgs[i]->buffer;
+			params[2] = {};
+			params[2].pName = "nearFieldPalettes";
+			params[2].ppBuffers = &pBufferNearFieldPalettes[i]->buffer;
+			params[3] = {};
+			params[3].pName = "crowdPalettes";
+			params[3].ppBuffers = &pBufferCrowdPalettes[i]->buffer;
+			updateDescriptorSet(renderer, i, pDescriptorSetNearFieldPalette[1], 4, params);
 
-		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+			params[0] = {};
+			params[0].pName = "nearFieldPalettes";
+			params[0].ppBuffers = &pBufferNearFieldPalettes[i]->buffer;
+			updateDescriptorSet(renderer, i, pDescriptorSetSkinningInstanced[1], 1, params);
+
+			params[0] = {};
+			params[0].pName = "vertexAnimation";
+			params[0].ppBuffers = &pBufferVertexAnimation->buffer;
+			params[1] = {};
+			params[1].pName = "billboardPositions";
+			params[1].ppBuffers = &pBufferQuadsPosition->buffer;
+			params[2] = {};
+			params[2].pName = "billboardPhases";
+			params[2].ppBuffers = &pBufferQuadPhases->buffer;
+			params[3] = {};
+			params[3].pName = "vatIndices";
+			params[3].ppBuffers = &pBufferVatIndices[i]->buffer;
+			DescriptorDataRange vatBlockRange = GetUploadRange(gUploadVatBlock, i);
+			params[4] = {};
+			params[4].pName = "vatBlock";
+			params[4].ppBuffers = &gUploadRing.pBuffer;
+			params[4].pRanges = &vatBlockRange;
+			params[5] = {};
+			params[5].pName = "billboardDirections";
+			params[5].ppBuffers = &pBufferQuadDirection->buffer;
+			updateDescriptorSet(renderer, i, pDescriptorSetVatMesh[1], 6, params);
+		}
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
 		{
 			params[0] = {};
-			params[0].pName = "jointWorldMats";
-			params[0].ppBuffers = &pBufferJointWorldMats[i]->buffer;
+			params[0].pName = "imposterClusters";
+			params[0].ppBuffers = &pBufferImposterClusters->buffer;
+
+			DescriptorDataRange frustumRange = GetUploadRange(gUploadFrustum, i);
 			params[1] = {};
-			params[1].pName = "jointModelMats";
-			params[1].ppBuffers = &pBufferJointModelMats[i]->buffer;
+			params[1].pName = "frustumBlock";
+			params[1].ppBuffers = &gUploadRing.pBuffer;
+			params[1].pRanges = &frustumRange;
+
 			params[2] = {};
-			params[2].pName = "jointScales";
-			params[2].ppBuffers = &pBufferJointScales[i]->buffer;
+			params[2].pName = "visibleClusters";
+			params[2].ppBuffers = &pBufferVisibleClusters[i]->buffer;
+
 			params[3] = {};
-			params[3].pName = "boneWorldMats";
-			params[3].ppBuffers = &pBufferBoneWorldMats[i]->buffer;
+			params[3].pName = "clusterDispatchArgs";
+			params[3].ppBuffers = &pBufferClusterDispatchArgs[i]->buffer;
 
-			updateDescriptorSet(renderer, i, pDescriptorSetAnimAccelerator[1], 4, params);
+			updateDescriptorSet(renderer, i, pDescriptorSetClusterCull, 4, params);
 		}
-	}
 
-	////////////////////////////////////////////////////////////////////////////////////
+		//Mip 0 reads the depth buffer, every other mip the one above it.
+		for (uint32_t i = 0; i < gHiZMipCount; ++i)
+		{
+			params[0] = {};
+			params[0].pName = "srcDepth";
+			params[0].ppTextures = &pDepthBuffer->pTexture;
+
+			params[1] = {};
+			params[1].pName = "srcHiZ";
+			params[1].ppTextures = &pTextureHiZ;
+			params[1].mUAVMipSlice = i > 0 ? i - 1 : 0;
+
+			params[2] = {};
+			params[2].pName = "dstHiZ";
+			params[2].ppTextures = &pTextureHiZ;
+			params[2].mUAVMipSlice = i;
+
+			updateDescriptorSet(renderer, i, pDescriptorSetHiZBuild, 3, params);
+		}
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			params[0] = {};
+			params[0].pName = "billboardPositions";
+			params[0].ppBuffers = &pBufferQuadsPosition->buffer;
+
+			params[1] = {};
+			params[1].pName = "occlusionCandidates";
+			params[1].ppBuffers = &pBufferOcclusionCandidates[i]->buffer;
+
+			params[2] = {};
+			params[2].pName = "occlusionCounters";
+			params[2].ppBuffers = &pBufferOcclusionCounters[i]->buffer;
+
+			params[3] = {};
+			params[3].pName = "hizTexture";
+			params[3].ppTextures = &pTextureHiZ;
+
+			DescriptorDataRange occlusionRange = GetUploadRange(gUploadOcclusion, i);
+			params[4] = {};
+			params[4].pName = "occlusionBlock";
+			params[4].ppBuffers = &gUploadRing.pBuffer;
+			params[4].pRanges = &occlusionRange;
+
+			params[5] = {};
+			params[5].pName = "retestIndices";
+			params[5].ppBuffers = &pBufferRetestIndices[i]->buffer;
+
+			params[6] = {};
+			params[6].pName = "retestIndirectArgs";
+			params[6].ppBuffers = &pBufferRetestIndirectArgs[i]->buffer;
+
+			updateDescriptorSet(renderer, i, pDescriptorSetOcclusionRetest, 7, params);
+		}
+
+		params[0] = {};
+		params[0].pName = "jointParentSlots";
+		params[0].ppBuffers = &pBufferJointParentsIndex->buffer;
+		params[1] = {};
+		params[1].pName = "jointRemaps";
+		params[1].ppBuffers = &pBufferJointRemaps->buffer;
+		params[2] = {};
+		params[2].pName = "inverseBindPoses";
+		params[2].ppBuffers = &pBufferInverseBindPoses->buffer;
+		params[3] = {};
+		params[3].pName = "jointLevelOrder";
+		params[3].ppBuffers = &pBufferJointLevelOrder->buffer;
+		params[4] = {};
+		params[4].pName = "jointLevelRanges";
+		params[4].ppBuffers = &pBufferJointLevelRanges->buffer;
+		params[5] = {};
+		params[5].pName = "poseRotations";
+		params[5].ppBuffers = &pBufferPoseRotations->buffer;
+		params[6] = {};
+		params[6].pName = "poseTranslations";
+		params[6].ppBuffers = &pBufferPoseTranslations->buffer;
+		params[7] = {};
+		params[7].pName = "poseScales";
+		params[7].ppBuffers = &pBufferPoseScales->buffer;
+		updateDescriptorSet(renderer, 0, pDescriptorSetAnimAccelerator[0], 8, params);
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			params[0] = {};
+			params[0].pName = "jointWorldMats";
+			params[0].ppBuffers = &pBufferJointWorldMats[i]->buffer;
+			params[1] = {};
+			params[1].pName = "jointModelMats";
+			params[1].ppBuffers = &pBufferJointModelMats[i]->buffer;
+			params[2] = {};
+			params[2].pName = "jointScales";
+			params[2].ppBuffers = &pBufferJointScales[i]->buffer;
+			params[3] = {};
+			params[3].pName = "boneWorldMats";
+			params[3].ppBuffers = &pBufferBoneWorldMats[i]->buffer;
+			params[4] = {};
+			params[4].pName = "bonePalette";
+			params[4].ppBuffers = &pBufferBonePalette[i]->buffer;
+
+			updateDescriptorSet(renderer, i, pDescriptorSetAnimAccelerator[1], 5, params);
+		}
+
+		for (uint32_t i = 0; i < MaxDataBufferCount; ++i)
+		{
+			params[0] = {};
+			params[0].pName = "boneMatrices";
+			params[0].ppBuffers = &pBufferBonePalette[i]->buffer;
+			params[1] = {};
+			params[1].pName = "inputVertices";
+			params[1].ppBuffers = &pGeom->pVertexBuffers[0];
+			params[2] = {};
+			params[2].pName = "skinnedVertices";
+			params[2].ppBuffers = &pBufferSkinnedVertices[i]->buffer;
+
+			updateDescriptorSet(renderer, i, pDescriptorSetSkinningCompute, 3, params);
+		}
+	}
+
+	void UpdateImposterTextureHeap()
+	{
+		//Slot a is archetype a's live atlas, slot MaxImposterArchetypes + a its baked slices.
+		//Only the live archetype is captured, the others show frame 0 of their bake in live mode.
+		//Missing bakes and unused slots alias the live archetype so no index samples a null descriptor.
+		//Every slot gets the layout of the texture it ended up with, bakes keep the one they were baked in.
+		Texture* pLive = gImposterAtlas.pColor->pTexture;
+		const ImposterHeapLayout liveLayout = GetImposterHeapLayout(1, gImposterAtlas.mViewCount, gImposterViewLayout);
+		Texture* pLiveBake = pImposterBakeTextures[gLiveArchetype] ? pImposterBakeTextures[gLiveArchetype] : pLive;
+		const ImposterHeapLayout liveBakeLayout = pImposterBakeTextures[gLiveArchetype] ? GetImposterBakeLayout(gLiveArchetype) : liveLayout;
+
+		ImposterHeapLayout layouts[ImposterTextureHeapSize];
+		for (uint32_t i = 0; i < MaxImposterArchetypes; ++i)
+		{
+			Texture* pBake = i < gImposterArchetypeCount ? pImposterBakeTextures[i] : NULL;
+			const bool live = i == gLiveArchetype || !pBake;
+			gImposterTextureHeap[i] = live ? pLive : pBake;
+			layouts[i] = live ? liveLayout : GetImposterBakeLayout(i);
+			gImposterTextureHeap[MaxImposterArchetypes + i] = pBake ? pBake : pLiveBake;
+			layouts[MaxImposterArchetypes + i] = pBake ? GetImposterBakeLayout(i) : liveBakeLayout;
+		}
+		pBufferImposterHeapLayouts->UpdateData(layouts);
+
+		DescriptorData params[2] = {};
+		params[0].pName = "imposterTextureHeap";
+		params[0].ppTextures = gImposterTextureHeap;
+		params[0].mCount = ImposterTextureHeapSize;
+		params[1].pName = "imposterHeapLayouts";
+		params[1].ppBuffers = &pBufferImposterHeapLayouts->buffer;
+		updateDescriptorSet(renderer, 0, pDescriptorSetImposterHeap, 2, params);
+	}
+
+	ImposterHeapLayout GetImposterHeapLayout(uint32_t frameCount, uint32_t viewCount, uint32_t layout)
+	{
+		return { frameCount, viewCount, layout, layout == IMPOSTER_VIEW_LAYOUT_RING_Y ? 0u : (uint32_t)OctahedralGridSize };
+	}
+
+	ImposterHeapLayout GetImposterBakeLayout(uint32_t archetype)
+	{
+		const ImposterBakeHeader& header = gImposterBakeHeaders[archetype];
+		return GetImposterHeapLayout(header.mFrameCount, header.mViewCount, header.mViewLayout);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
 	//										UnLoad Funcs							  //
 	////////////////////////////////////////////////////////////////////////////////////
 	void RemoveShaders()
@@ -1990,6 +5322,16 @@ class ImposterRendering: public IApp
 		removeShader(renderer, pShaderQuad);
 		removeShader(renderer, pShaderAngleCompute);
 		removeShader(renderer, pShaderAnimAccelerator);
+		removeShader(renderer, pShaderSkinningCompute);
+		removeShader(renderer, pShaderPosedMesh);
+		if (gMultiViewCaptureSupported)
+			removeShader(renderer, pShaderPosedMeshMultiView);
+		removeShader(renderer, pShaderHiZBuild);
+		removeShader(renderer, pShaderOcclusionRetest);
+		removeShader(renderer, pShaderClusterCull);
+		removeShader(renderer, pShaderNearFieldPalette);
+		removeShader(renderer, pShaderSkinningInstanced);
+		removeShader(renderer, pShaderVatMesh);
 	}
 
 	void RemoveDescriptorSets()
@@ -1999,9 +5341,26 @@ class ImposterRendering: public IApp
 		removeDescriptorSet(renderer, pDescriptorSetSkinning[0]);
 		removeDescriptorSet(renderer, pDescriptorSetSkinning[1]);
 		removeDescriptorSet(renderer, pDescriptorQuad);
+		removeDescriptorSet(renderer, pDescriptorSetImposterHeap);
 		removeDescriptorSet(renderer, pDescriptorSetCompAngleCompute);
 		removeDescriptorSet(renderer, pDescriptorSetAnimAccelerator[0]);
 		removeDescriptorSet(renderer, pDescriptorSetAnimAccelerator[1]);
+		removeDescriptorSet(renderer, pDescriptorSetSkinningCompute);
+		removeDescriptorSet(renderer, pDescriptorSetPosedMesh);
+		if (gMultiViewCaptureSupported)
+		{
+			removeDescriptorSet(renderer, pDescriptorSetPosedMeshMultiView[0]);
+			removeDescriptorSet(renderer, pDescriptorSetPosedMeshMultiView[1]);
+		}
+		removeDescriptorSet(renderer, pDescriptorSetHiZBuild);
+		removeDescriptorSet(renderer, pDescriptorSetOcclusionRetest);
+		removeDescriptorSet(renderer, pDescriptorSetClusterCull);
+		removeDescriptorSet(renderer, pDescriptorSetNearFieldPalette[0]);
+		removeDescriptorSet(renderer, pDescriptorSetNearFieldPalette[1]);
+		removeDescriptorSet(renderer, pDescriptorSetSkinningInstanced[0]);
+		removeDescriptorSet(renderer, pDescriptorSetSkinningInstanced[1]);
+		removeDescriptorSet(renderer, pDescriptorSetVatMesh[0]);
+		removeDescriptorSet(renderer, pDescriptorSetVatMesh[1]);
 	}
 
 	void RemoveRootSignatures()
@@ -2012,6 +5371,16 @@ class ImposterRendering: public IApp
 		removeRootSignature(renderer, pRootSignatureQuad);
 		removeRootSignature(renderer, pRootSigCompAngleCompute);
 		removeRootSignature(renderer, pRootSigAnimAccelerator);
+		removeRootSignature(renderer, pRootSigSkinningCompute);
+		removeRootSignature(renderer, pRootSignaturePosedMesh);
+		if (gMultiViewCaptureSupported)
+			removeRootSignature(renderer, pRootSignaturePosedMeshMultiView);
+		removeRootSignature(renderer, pRootSigHiZBuild);
+		removeRootSignature(renderer, pRootSigOcclusionRetest);
+		removeRootSignature(renderer, pRootSigClusterCull);
+		removeRootSignature(renderer, pRootSigNearFieldPalette);
+		removeRootSignature(renderer, pRootSignatureSkinningInstanced);
+		removeRootSignature(renderer, pRootSignatureVatMesh);
 	}
 
 	void RemovePipelines()
@@ -2020,28 +5389,66 @@ class ImposterRendering: public IApp
 		removePipeline(renderer, pPipelineSkinning);
 		removePipeline(renderer, pPlaneDrawPipeline);
 		removePipeline(renderer, pPipelineQuad);
+		removePipeline(renderer, pPipelineQuadShadow);
 		removePipeline(renderer, pPipelineCompAngleCompute);
+		removeIndirectCommandSignature(renderer, pCmdSignatureQuad);
+		removeIndirectCommandSignature(renderer, pCmdSignatureRetestDispatch);
 		removePipeline(renderer, pPipelineAnimAccelerator);
+		removePipeline(renderer, pPipelineSkinningCompute);
+		removePipeline(renderer, pPipelinePosedMesh);
+		if (gMultiViewCaptureSupported)
+			removePipeline(renderer, pPipelinePosedMeshMultiView);
+		removePipeline(renderer, pPipelineHiZBuild);
+		removePipeline(renderer, pPipelineOcclusionRetest);
+		removePipeline(renderer, pPipelineClusterCull);
+		removeIndirectCommandSignature(renderer, pCmdSignatureClusterDispatch);
+		removePipeline(renderer, pPipelineNearFieldPalette);
+		removePipeline(renderer, pPipelineSkinningInstanced);
+		removeIndirectCommandSignature(renderer, pCmdSignatureNearField);
+		removePipeline(renderer, pPipelineVatMesh);
+		removeIndirectCommandSignature(renderer, pCmdSignatureVat);
+	}
+
+	void RemoveImposterAtlas(ImposterAtlas* pAtlas)
+	{
+		//Remove imposter atlas.
+		removeRenderTarget(renderer, pAtlas->pColor);
+		removeRenderTarget(renderer, pAtlas->pDepth);
+		*pAtlas = {};
 	}
 
 	void RemoveRenderTargets()
 	{
 		//Remove rendertargets.
-		for (int i = 0; i < TextureCount; ++i)
-			removeRenderTarget(renderer, rts[i]);
-
 		removeRenderTarget(renderer, shadowDepthRT);
-		removeRenderTarget(renderer, shadowRT);
 		removeRenderTarget(renderer, pDepthBuffer);
+		removeResource(pTextureHiZ);
 	}
 
 	////////////////////////////////////////////////////////////////////////////////////
 	//									ComputeShaders Funcs						  //
 	////////////////////////////////////////////////////////////////////////////////////
-	void DispatchAngleCompute(Cmd* cmd)
+	void ExtractClipPlanes(const mat4& viewProj, vec4* pPlanes)
+	{
+		//Inward planes of a [0, 1] depth clip volume, normalized like extractFrustumClipPlanes.
+		const vec4 row0 = viewProj.getRow(0);
+		const vec4 row1 = viewProj.getRow(1);
+		const vec4 row2 = viewProj.getRow(2);
+		const vec4 row3 = viewProj.getRow(3);
+		pPlanes[0] = row3 + row0;
+		pPlanes[1] = row3 - row0;
+		pPlanes[2] = row3 + row1;
+		pPlanes[3] = row3 - row1;
+		pPlanes[4] = row2;
+		pPlanes[5] = row3 - row2;
+		for (uint32_t i = 0; i < 6; ++i)
+			pPlanes[i] /= length(pPlanes[i].getXYZ());
+	}
+
+	void DispatchAngleCompute(Cmd* cmd, ProfileToken token)
 	{
 		//Angle computing dispatch.
-		cmdBeginGpuTimestampQuery(cmd, NULL, "Angle Comp Dispatch Start");
+		cmdBeginGpuTimestampQuery(cmd, token, "Angle Comp Dispatch Start");
 		uint32_t billboardConstantIndex = getDescriptorIndexFromName(pRootSigCompAngleCompute, "billboardsRootConstant");
 
 		vec3 camPos = mainCamera->getViewPosition();
@@ -2049,230 +5456,1720 @@ class ImposterRendering: public IApp
 
 		if (gUIData.mGeneralSettings.mFrustumOn)
 		{
-			CameraMatrix::extractFrustumClipPlanes(viewProjMatMainCamera, frustumPlanes[0], frustumPlanes[1],
-				frustumPlanes[2], frustumPlanes[3], frustumPlanes[4], frustumPlanes[5], true);
-			pBufferFrustumPlanes->UpdateData(frustumPlanes);
+			CameraMatrix::extractFrustumClipPlanes(viewProjMatMainCamera, frustumBlock.mPlanes[0], frustumBlock.mPlanes[1],
+				frustumBlock.mPlanes[2], frustumBlock.mPlanes[3], frustumBlock.mPlanes[4], frustumBlock.mPlanes[5], true);
 		}
+		//Shadow casters are culled against the light alone, casters off camera still throw shadows into view.
+		if (gUIData.mGeneralSettings.mDrawShadows)
+			ExtractClipPlanes(lightProjMat, frustumBlock.mLightPlanes);
+		//Every frame, the ring slot does not keep last frame's planes.
+		WriteUpload(gUploadFrustum, &frustumBlock, sizeof(frustumBlock));
 
 		billboardRootConstantBlock.camPos = float4(camPos.getX(), camPos.getY(), camPos.getZ(), 1.f);
 		billboardRootConstantBlock.lightPos = float4(lightPos.getX(), lightPos.getY(), lightPos.getZ(), 1.f);
 		billboardRootConstantBlock.frustumOn = gUIData.mGeneralSettings.mFrustumOn ? 1 : 0;
+		//In the compute genShadow asks for the light's caster list, the draws set it per pass.
+		billboardRootConstantBlock.genShadow = gUIData.mGeneralSettings.mDrawShadows ? 1 : 0;
 		billboardRootConstantBlock.imposter360 = gUIData.mGeneralSettings.mUsing360Imposter ? 1 : 0;
 		billboardRootConstantBlock.imposterCount = imposterCount;
+		billboardRootConstantBlock.captureFrameStamp = (int)gCaptureScheduler.mFrameStamp;
+		billboardRootConstantBlock.compactedDraw = gUIData.mGeneralSettings.mCompactedDraws ? 1 : 0;
+		billboardRootConstantBlock.nearFieldCount = NearFieldActive() ? gUIData.mGeneralSettings.nearFieldCount : 0;
+		billboardRootConstantBlock.nearFieldDistance = gUIData.mGeneralSettings.nearFieldDistance;
+		billboardRootConstantBlock.vatMaxCount = VatActive() ? MaxVatCount : 0;
+		billboardRootConstantBlock.vatDistance = gUIData.mGeneralSettings.vatDistance;
+		//Near and mid field draw the live archetype's mesh, other archetypes stay imposters at any distance.
+		billboardRootConstantBlock.liveArchetype = (int)gLiveArchetype;
+		SetImposterLookupConstants(billboardRootConstantBlock);
+
+		//Phase one tests against last frame's pyramid, with the matrix it was rendered with.
+		occlusionBlock.mHiZViewProj = gHiZViewProj;
+		occlusionBlock.mViewProj = viewProjMatMainCamera.getPrimaryMatrix();
+		occlusionBlock.mHiZSize = float2((float)pTextureHiZ->mWidth, (float)pTextureHiZ->mHeight);
+		occlusionBlock.mHiZMipCount = gHiZMipCount;
+		occlusionBlock.mOcclusionOn = (OcclusionCullingActive() && gHiZValid) ? 1 : 0;
+		WriteUpload(gUploadOcclusion, &occlusionBlock, sizeof(occlusionBlock));
+		ResetOcclusionCounters(cmd);
+
+		//Zero the append counters, then let the compute append visible and promoted instances.
+		Buffer* pIndirectArgs = pBufferQuadIndirectArgs[gFrameIndex]->buffer;
+		Buffer* pNearFieldArgs = pBufferNearFieldArgs[gFrameIndex]->buffer;
+		Buffer* pVatArgs = pBufferVatArgs[gFrameIndex]->buffer;
+		Buffer* pHistogram = pBufferNearFieldHistogram[gFrameIndex]->buffer;
+		Buffer* pShadowArgs = pBufferShadowIndirectArgs[gFrameIndex]->buffer;
+		BufferBarrier compactionBarriers[9] = {
+			{ pIndirectArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_COPY_DEST },
+			{ pNearFieldArgs, RESOURCE_STATE_INDIRECT_ARGUMENT | RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_COPY_DEST },
+			{ pVatArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_COPY_DEST },
+			{ pHistogram, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_DEST },
+			{ pBufferVisibleIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS },
+			{ pBufferNearFieldIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS },
+			{ pBufferVatIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS },
+			{ pShadowArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_COPY_DEST },
+			{ pBufferShadowIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS } };
+		cmdResourceBarrier(cmd, 9, compactionBarriers, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pIndirectArgs, 0, pBufferQuadIndirectArgsReset->buffer, 0, pBufferQuadIndirectArgsReset->size);
+		cmdUpdateBuffer(cmd, pNearFieldArgs, 0, pBufferNearFieldArgsReset->buffer, 0, pBufferNearFieldArgsReset->size);
+		cmdUpdateBuffer(cmd, pVatArgs, 0, pBufferVatArgsReset->buffer, 0, pBufferVatArgsReset->size);
+		cmdUpdateBuffer(cmd, pHistogram, 0, pBufferNearFieldHistogramReset->buffer, 0, pBufferNearFieldHistogramReset->size);
+		cmdUpdateBuffer(cmd, pShadowArgs, 0, pBufferQuadIndirectArgsReset->buffer, 0, pBufferQuadIndirectArgsReset->size);
+		compactionBarriers[0] = { pIndirectArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		compactionBarriers[1] = { pNearFieldArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		compactionBarriers[2] = { pVatArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		compactionBarriers[3] = { pHistogram, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		compactionBarriers[4] = { pShadowArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 5, compactionBarriers, 0, NULL, 0, NULL);
+
+		//Clusters first, the angle compute then only walks instances of surviving clusters.
+		const bool clustered = gUIData.mGeneralSettings.mClusterCulling && gUIData.mGeneralSettings.mFrustumOn;
+		billboardRootConstantBlock.clusteredCull = clustered ? 1 : 0;
+		if (clustered)
+			DispatchClusterCull(cmd);
 
-		cmdBindPushConstants(cmd, pRootSigCompAngleCompute, billboardConstantIndex, &billboardRootConstantBlock);
 		cmdBeginDebugMarker(cmd, 1, 0, 1, "Angle Computation");
 		cmdBindPipeline(cmd, pPipelineCompAngleCompute);
 		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetCompAngleCompute);
-		cmdDispatch(cmd, imposterCount / 32 + 1, 1, 1);
+
+		//Near field candidates are counted per distance bin first, the main pass then promotes every bin
+		//below the one that reaches nearFieldCount and fills the remaining slots from that boundary bin.
+		if (billboardRootConstantBlock.nearFieldCount > 0)
+		{
+			billboardRootConstantBlock.nearFieldHistogramPass = 1;
+			cmdBindPushConstants(cmd, pRootSigCompAngleCompute, billboardConstantIndex, &billboardRootConstantBlock);
+			RecordAngleComputeDispatch(cmd, clustered);
+
+			BufferBarrier histogramBarrier = { pHistogram, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS };
+			cmdResourceBarrier(cmd, 1, &histogramBarrier, 0, NULL, 0, NULL);
+		}
+
+		billboardRootConstantBlock.nearFieldHistogramPass = 0;
+		cmdBindPushConstants(cmd, pRootSigCompAngleCompute, billboardConstantIndex, &billboardRootConstantBlock);
+		RecordAngleComputeDispatch(cmd, clustered);
 		cmdEndDebugMarker(cmd);
-		cmdEndGpuTimestampQuery(cmd, NULL);
+
+		//The palette compute reads the near field count straight from the draw args.
+		compactionBarriers[0] = { pIndirectArgs, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		compactionBarriers[1] = { pNearFieldArgs, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT | RESOURCE_STATE_SHADER_RESOURCE };
+		compactionBarriers[2] = { pVatArgs, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		compactionBarriers[3] = { pBufferVisibleIndices[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		compactionBarriers[4] = { pBufferNearFieldIndices[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		compactionBarriers[5] = { pBufferVatIndices[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		compactionBarriers[6] = { pBufferRetestDispatchArgs[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		compactionBarriers[7] = { pShadowArgs, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		compactionBarriers[8] = { pBufferShadowIndices[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		cmdResourceBarrier(cmd, 9, compactionBarriers, 0, NULL, 0, NULL);
+		cmdEndGpuTimestampQuery(cmd, token);
 	}
 
-	void DispatchAnimAccelCompute(Cmd* cmd)
+	bool AsyncComputeActive()
 	{
-		//Skinning accel dispatch.
-
-		//Before dispatch, update joint modelmats.
-		pBufferJointModelMats[gFrameIndex]->UpdateData(gStickFigureAnimObject->mJointModelMats.begin());
-
-		cmdBeginDebugMarker(cmd, 1, 0, 1, "AnimAccel Computation");
+		return gUIData.mGeneralSettings.mAsyncCompute;
+	}
 
-		cmdBindPipeline(cmd, pPipelineAnimAccelerator);
-		cmdBindDescriptorSet(cmd, 0, pDescriptorSetAnimAccelerator[0]);
-		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetAnimAccelerator[1]);
-		cmdDispatch(cmd, 1, 1, 1);
+	void DrainQueues()
+	{
+		//Resources may be owned by either queue, drain both.
+		waitQueueIdle(queue);
+		waitQueueIdle(pComputeQueue);
 
-		cmdEndDebugMarker(cmd);
+		//A signaled semaphore nobody will wait on has to be recreated.
+		if (gHiZBuiltSemaphorePending)
+		{
+			removeSemaphore(renderer, pHiZBuiltSemaphore);
+			addSemaphore(renderer, &pHiZBuiltSemaphore);
+			gHiZBuiltSemaphorePending = false;
+		}
+	}
 
-		//Aft dispatch, copy results to stick figure object.
-		pBufferJointWorldMats[gFrameIndex]->ReadData(gStickFigureAnimObject->mJointWorldMats.begin());
-		pBufferJointScales[gFrameIndex]->ReadData(gStickFigureAnimObject->mJointScales.begin());
-		pBufferBoneWorldMats[gFrameIndex]->ReadData(gStickFigureAnimObject->mBoneWorldMats.begin());
+	void ApplyAsyncCompute(bool enable)
+	{
+		DrainQueues();
+		gAsyncComputeLastFrame = enable;
 	}
 
-	////////////////////////////////////////////////////////////////////////////////////
-	//									RenderTargets Funcs							  //
-	////////////////////////////////////////////////////////////////////////////////////
-	void CaptureToRT(Cmd* cmd_)
+	void ApplyFramesInFlight(uint32_t count)
 	{
-		//Capture skinning animation to rts.
-		cmdBeginGpuTimestampQuery(cmd_, NULL, "Generate Capture of SkinnedMesh");
-		
-		const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignatureSkinning, "transformRootConstant");
+		//Per frame resources exist for MaxDataBufferCount frames already, only the rings change size.
+		DrainQueues();
+		RemoveCmdRings();
+		gDataBufferCount = count;
+		AddCmdRings();
 
-		MatrixBlock mvpMatrixBlock;
-		mvpMatrixBlock.mProjMat = imposterProjMatrix;
-		mvpMatrixBlock.mViewMat = imposterViewMatrix;
+		//Slots restart at 0, nothing written under the old cycle is pending anymore.
+		gFrameIndex = 0;
+		memset(gOcclusionReadbackReady, 0, sizeof(gOcclusionReadbackReady));
+		memset(gJointWorldMatsReadbackReady, 0, sizeof(gJointWorldMatsReadbackReady));
+		//A zero stamp keeps the scheduler off angle bin readbacks the new cycle has not written yet.
+		memset(gCaptureScheduler.mReadbackStamps, 0, sizeof(gCaptureScheduler.mReadbackStamps));
+		memset(gFrameLatency, 0, sizeof(gFrameLatency));
+	}
 
-		for (int i = 0; i < TextureCount; ++i)
+	bool CalibrateGpuClock(uint64_t* pGpuTicks, int64_t* pCpuUSec)
+	{
+		//Both clocks sampled at the same instant, the CPU one in getUSec units.
+		uint64_t cpuTicks = 0;
+		int64_t cpuFrequency = 0;
+#if defined(DIRECT3D12)
+#if defined(USE_MULTIPLE_RENDER_APIS)
+		if (gSelectedRendererApi == RENDERER_API_D3D12)
+#endif
 		{
-			RenderTarget* renderTarget = rts[i];
-
-			cmdBindRenderTargets(cmd_, 1, &renderTarget, pDepthBuffer, &clearLoadAction, NULL, NULL, -1, -1);
-			cmdSetViewport(cmd_, 0.f, 0.f, (float)renderTarget->mWidth, (float)renderTarget->mHeight, 0.f, 1.f);
-			cmdSetScissor(cmd_, 0, 0, renderTarget->mWidth, renderTarget->mHeight);
-			cmdBindPipeline(cmd_, pPipelineSkinning);
-			cmdBindDescriptorSet(cmd_, 0, pDescriptorSetSkinning[0]);
-			cmdBindDescriptorSet(cmd_, gFrameIndex, pDescriptorSetSkinning[1]);
-			mvpMatrixBlock.mToWorldMat = imposterRotationMatrices[i];
-			cmdBindPushConstants(cmd_, pRootSignatureSkinning, transformRootConstantIndex, &mvpMatrixBlock);
-			cmdBindVertexBuffer(cmd_, 1, &pGeom->pVertexBuffers[0], pGeom->mVertexStrides, NULL);
-			cmdBindIndexBuffer(cmd_, pGeom->pIndexBuffer, pGeom->mIndexType, NULL);
-			cmdDrawIndexed(cmd_, pGeom->mIndexCount, 0, 0);
-			cmdBindRenderTargets(cmd_, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
+			if (FAILED(queue->mDx.pQueue->GetClockCalibration(pGpuTicks, &cpuTicks)))
+				return false;
+			cpuFrequency = getTimerFrequency();
+		}
+#endif
+#if defined(VULKAN)
+#if defined(USE_MULTIPLE_RENDER_APIS)
+		if (gSelectedRendererApi == RENDERER_API_VULKAN)
+#endif
+		{
+			VkCalibratedTimestampInfoEXT infos[2] = {};
+			infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+			infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+			infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+			infos[1].timeDomain = GetHostTimeDomain();
+			uint64_t timestamps[2] = {};
+			uint64_t maxDeviation = 0;
+			if (vkGetCalibratedTimestampsEXT(renderer->mVk.pDevice, 2, infos, timestamps, &maxDeviation) != VK_SUCCESS)
+				return false;
+			*pGpuTicks = timestamps[0];
+			cpuTicks = timestamps[1];
+#if defined(_WINDOWS)
+			cpuFrequency = getTimerFrequency();
+#else
+			cpuFrequency = 1000000000;
+#endif
 		}
+#endif
+		if (!cpuFrequency)
+			return false;
 
-		cmdEndGpuTimestampQuery(cmd_, NULL);
+		//Split so the tick count times a million does not overflow.
+		const uint64_t frequency = (uint64_t)cpuFrequency;
+		*pCpuUSec = (int64_t)((cpuTicks / frequency) * 1000000 + (cpuTicks % frequency) * 1000000 / frequency);
+		return true;
 	}
 
-	void BindDefaultRT(Cmd* cmd_, uint32_t swapChainIndex)
+	void PollFrameLatency()
 	{
-		//Back to default swapchain rtv.
-		RenderTarget* pRenderTarget = pSwapChain->ppRenderTargets[swapChainIndex];
+		//Input to the frame end timestamp mapped onto the CPU clock, up to when the fence is first seen signaled without calibration.
+		uint64_t gpuBase = 0;
+		int64_t cpuBase = 0;
+		const bool calibrated = gGpuClockCalibrationSupported && CalibrateGpuClock(&gpuBase, &cpuBase);
+		const int64_t now = getUSec(false);
+		bool timestampsRead = false;
+		for (uint32_t i = 0; i < gDataBufferCount; ++i)
+		{
+			FrameLatency& frame = gFrameLatency[i];
+			if (!frame.pFence)
+				continue;
 
-		RenderTargetBarrier barrier = {pRenderTarget, RESOURCE_STATE_PRESENT, RESOURCE_STATE_RENDER_TARGET};
+			FenceStatus status;
+			getFenceStatus(renderer, frame.pFence, &status);
+			if (status != FENCE_STATUS_COMPLETE)
+				continue;
 
-		cmdResourceBarrier(cmd_, 0, NULL, 0, NULL, 1, &barrier);
-		cmdBindRenderTargets(cmd_, 1, &pRenderTarget, pDepthBuffer, &clearLoadAction, NULL, NULL, -1, -1);
-		cmdSetViewport(cmd_, 0.f, 0.f, (float)pRenderTarget->mWidth, (float)pRenderTarget->mHeight, 0.f, 1.f);
-		cmdSetScissor(cmd_, 0, 0, pRenderTarget->mWidth, pRenderTarget->mHeight);
+			int64_t frameEnd = now;
+			if (calibrated)
+			{
+				if (!timestampsRead)
+				{
+					pBufferLatencyReadback->ReadData(gLatencyTimestamps);
+					timestampsRead = true;
+				}
+				frameEnd = cpuBase + (int64_t)(((double)gLatencyTimestamps[i] - (double)gpuBase) * 1000000.0 / gGpuTimestampFrequency);
+			}
+
+			const float latencyMs = (float)(frameEnd - frame.mInputTime) / 1000.f;
+			gInputLatencyMs = gInputLatencyMs > 0.f ? gInputLatencyMs * 0.9f + latencyMs * 0.1f : latencyMs;
+			frame.pFence = NULL;
+		}
 	}
 
-	
-	////////////////////////////////////////////////////////////////////////////////////
-	//									Render Funcs								  //
-	////////////////////////////////////////////////////////////////////////////////////
-	void RenderQuads(Cmd* cmd)
+	uint32_t GatherAsyncComputeBuffers(BufferBarrier* pBarriers)
 	{
-		//Rendering Quads with capturing.
-		constexpr uint32_t stride = sizeof(float) * 6;
-		const uint32_t billboardRootConstantIndex = getDescriptorIndexFromName(pRootSignatureQuad, "billboardsRootConstant");
+		//Compute queue outputs read by this frame's graphics work, in the state the compute passes leave them.
+		uint32_t count = 0;
+		pBarriers[count++] = { pBufferQuadAngles[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS };
+		pBarriers[count++] = { gUploadRing.pBuffer, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+		pBarriers[count++] = { pBufferBonePalette[gFrameIndex]->buffer, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+		pBarriers[count++] = { pBufferSkinnedVertices[gFrameIndex]->buffer, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+		pBarriers[count++] = { pBufferVisibleIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE };
+		pBarriers[count++] = { pBufferQuadIndirectArgs[gFrameIndex]->buffer, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		pBarriers[count++] = { pBufferShadowIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE };
+		pBarriers[count++] = { pBufferShadowIndirectArgs[gFrameIndex]->buffer, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		pBarriers[count++] = { pBufferNearFieldIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE };
+		pBarriers[count++] = { pBufferNearFieldArgs[gFrameIndex]->buffer, RESOURCE_STATE_INDIRECT_ARGUMENT | RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_INDIRECT_ARGUMENT | RESOURCE_STATE_SHADER_RESOURCE };
+		pBarriers[count++] = { pBufferNearFieldPalettes[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE };
+		pBarriers[count++] = { pBufferVatIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE };
+		pBarriers[count++] = { pBufferVatArgs[gFrameIndex]->buffer, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		pBarriers[count++] = { pBufferRetestDispatchArgs[gFrameIndex]->buffer, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		pBarriers[count++] = { pBufferOcclusionCandidates[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS };
+		pBarriers[count++] = { pBufferRetestIndirectArgs[gFrameIndex]->buffer, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		pBarriers[count++] = { pBufferOcclusionCounters[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS };
+		return count;
+	}
 
-		billboardRootConstantBlock.showQuads = gUIData.mGeneralSettings.mShowQuads ? 1 : 0;
-		billboardRootConstantBlock.genShadow = 0;
+	void TransferAsyncComputeOwnership(Cmd* cmd, bool release)
+	{
+		//Queue family ownership, released on the compute queue and acquired on the graphics queue.
+		BufferBarrier barriers[32];
+		const uint32_t count = GatherAsyncComputeBuffers(barriers);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			barriers[i].mRelease = release ? 1 : 0;
+			barriers[i].mAcquire = release ? 0 : 1;
+			barriers[i].mQueueType = release ? QUEUE_TYPE_GRAPHICS : QUEUE_TYPE_COMPUTE;
+		}
+		cmdResourceBarrier(cmd, count, barriers, 0, NULL, 0, NULL);
+	}
 
-		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Quads");
-		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Quad");
-		cmdBindPushConstants(cmd, pRootSignatureQuad, billboardRootConstantIndex, &billboardRootConstantBlock);
-		cmdBindPipeline(cmd, pPipelineQuad);
-		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorQuad);
-		cmdBindVertexBuffer(cmd, 1, &pBufferQuadVertex->buffer, &stride, NULL);
-		cmdDrawInstanced(cmd, 6, 0, imposterCount, 0);
-		cmdEndDebugMarker(cmd);
-		cmdEndGpuTimestampQuery(cmd, NULL);
+	void TransferHiZOwnership(Cmd* cmd, bool release, QueueType otherQueue)
+	{
+		//The pyramid is built on graphics and read by next frame's culling on compute.
+		TextureBarrier hizBarrier = { pTextureHiZ, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE };
+		hizBarrier.mRelease = release ? 1 : 0;
+		hizBarrier.mAcquire = release ? 0 : 1;
+		hizBarrier.mQueueType = otherQueue;
+		cmdResourceBarrier(cmd, 0, NULL, 1, &hizBarrier, 0, NULL);
 	}
 
-	void RenderPlane(Cmd* cmd)
+	void SubmitAsyncCompute(Cmd* computeCmd, GpuCmdRingElement& computeElem)
 	{
-		//RenderPlane with scene's depth infos.
-		const uint32_t stride = sizeof(float) * 6;
-		const uint32_t constantIndex = getDescriptorIndexFromName(pRootSignaturePlane, "lightPOVRootConstant");
+		//Hand this frame's outputs to graphics, which waits on the compute semaphore before reading them.
+		TransferAsyncComputeOwnership(computeCmd, true);
+		cmdEndGpuFrameProfile(computeCmd, gComputeProfileToken);
+		endCmd(computeCmd);
 
-		struct Data{
-			mat4 lightProjMat;
-			int drawShadow;
-		}data;
+		QueueSubmitDesc submitDesc = {};
+		submitDesc.mCmdCount = 1;
+		submitDesc.ppCmds = &computeCmd;
+		submitDesc.mSignalSemaphoreCount = 1;
+		submitDesc.ppSignalSemaphores = &computeElem.pSemaphore;
+		//Occlusion culling reads last frame's HiZ, the only thing compute has to wait for.
+		submitDesc.mWaitSemaphoreCount = gHiZBuiltSemaphorePending ? 1 : 0;
+		submitDesc.ppWaitSemaphores = &pHiZBuiltSemaphore;
+		submitDesc.pSignalFence = computeElem.pFence;
+		queueSubmit(pComputeQueue, &submitDesc);
+		gHiZBuiltSemaphorePending = false;
+	}
 
-		data.lightProjMat = lightProjMat;
-		data.drawShadow = gUIData.mGeneralSettings.mDrawShadows == true ? 1 : 0;
-		int drawShadows = gUIData.mGeneralSettings.mDrawShadows ? 1 : 0;
+	void RecordAngleComputeDispatch(Cmd* cmd, bool clustered)
+	{
+		//Clustered: group g takes visibleClusters[g] and thread i its i-th instance, flat: one thread per instance.
+		if (clustered)
+			cmdExecuteIndirect(cmd, pCmdSignatureClusterDispatch, 1, pBufferClusterDispatchArgs[gFrameIndex]->buffer, 0, NULL, 0);
+		else
+			cmdDispatch(cmd, imposterCount / AngleComputeGroupSize + 1, 1, 1);
+	}
 
-		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Plane");
-		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Plane");
-		cmdBindPipeline(cmd, pPlaneDrawPipeline);
-		cmdBindPushConstants(cmd, pRootSignaturePlane, constantIndex, &data);
-		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSet);
-		cmdBindVertexBuffer(cmd, 1, &pBufferPlaneVertex->buffer, &stride, NULL);
-		cmdDraw(cmd, 6, 0);
-		cmdEndDebugMarker(cmd);
-		cmdEndGpuTimestampQuery(cmd, NULL);
+	bool NearFieldActive()
+	{
+		//Promoted instances leave the compacted list, the full instanced draw would still show them as quads.
+		return gUIData.mGeneralSettings.mNearFieldSkinning && gUIData.mGeneralSettings.mCompactedDraws;
 	}
 
-	void RenderAnimation(Cmd* cmd)
+	bool VatActive()
 	{
-		//Rendering Skinning anims.
-		MatrixBlock data;
-		data.mProjMat = projViewModelMatrices.mProjMat;
-		data.mViewMat = projViewModelMatrices.mViewMat;
-		data.mToWorldMat = mat4::identity();
+		//Same constraint as the near field, plus the animation buffer must be baked.
+		return gUIData.mGeneralSettings.mVatMidField && gUIData.mGeneralSettings.mCompactedDraws && gVatBakedArchetype == gLiveArchetype;
+	}
 
-		const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignatureSkinning, "transformRootConstant");
+	void DispatchNearFieldPalettes(Cmd* cmd, ProfileToken token)
+	{
+		//One group per promoted slot, each samples the pose cache at its instance's phase and walks the levels.
+		if (!NearFieldActive())
+			return;
 
-		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Skinning Anim");
-		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Skinned Mesh");
-		cmdBindPipeline(cmd, pPipelineSkinning);
-		cmdBindPushConstants(cmd, pRootSignatureSkinning, transformRootConstantIndex, &data);
-		cmdBindDescriptorSet(cmd, 0, pDescriptorSetSkinning[0]);
-		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetSkinning[1]);
-		cmdBindVertexBuffer(cmd, 1, &pGeom->pVertexBuffers[0], pGeom->mVertexStrides, (uint64_t*)NULL);
-		cmdBindIndexBuffer(cmd, pGeom->pIndexBuffer, pGeom->mIndexType, (uint64_t)NULL);
-		cmdDrawIndexed(cmd, pGeom->mIndexCount, 0, 0);
+		const uint32_t rootConstantIndex = getDescriptorIndexFromName(pRootSigNearFieldPalette, "nearFieldRootConstant");
+		nearFieldRootConstantBlock.rootTransform = gStickFigureAnimObject->mRootTransform;
+		nearFieldRootConstantBlock.boneCount = pGeomData->mJointCount;
+		nearFieldRootConstantBlock.jointCount = gPoseCache.mJointCount;
+		nearFieldRootConstantBlock.poseFrameCount = gPoseCache.mFrameCount;
+		nearFieldRootConstantBlock.clipDuration = gPoseCache.mDuration;
+		nearFieldRootConstantBlock.animationTime = gUIData.mClip.mAnimationTime;
+		nearFieldRootConstantBlock.phaseSpread = gUIData.mGeneralSettings.phaseSpread;
+		//CPU animated crowd palettes replace the pose cache, instance i skins with crowd member i % crowdCount.
+		nearFieldRootConstantBlock.crowdCount = GpuAnimationPalette() ? 0 : gCrowdAnimTaskData.mCount;
+		nearFieldRootConstantBlock.imposter360 = gUIData.mGeneralSettings.mUsing360Imposter ? 1 : 0;
+
+		Buffer* pPalettes = pBufferNearFieldPalettes[gFrameIndex]->buffer;
+		BufferBarrier paletteBarrier = { pPalettes, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, &paletteBarrier, 0, NULL, 0, NULL);
+
+		cmdBeginGpuTimestampQuery(cmd, token, "Near Field Palettes");
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Near Field Palettes");
+		cmdBindPipeline(cmd, pPipelineNearFieldPalette);
+		cmdBindDescriptorSet(cmd, 0, pDescriptorSetNearFieldPalette[0]);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetNearFieldPalette[1]);
+		cmdBindPushConstants(cmd, pRootSigNearFieldPalette, rootConstantIndex, &nearFieldRootConstantBlock);
+		//Slots past the appended count exit early.
+		cmdDispatch(cmd, (uint32_t)gUIData.mGeneralSettings.nearFieldCount, 1, 1);
 		cmdEndDebugMarker(cmd);
-		cmdEndGpuTimestampQuery(cmd, NULL);
+		cmdEndGpuTimestampQuery(cmd, token);
+
+		paletteBarrier = { pPalettes, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		cmdResourceBarrier(cmd, 1, &paletteBarrier, 0, NULL, 0, NULL);
 	}
 
-	////////////////////////////////////////////////////////////////////////////////////
-	//									Shadow Funcs								  //
-	////////////////////////////////////////////////////////////////////////////////////
-	void FillShadowDepthRT(Cmd* cmd)
+	void DrawImposterQuads(Cmd* cmd, uint32_t drawPhase)
 	{
-		constexpr uint32_t stride = sizeof(float) * 6;
-
-		const uint32_t billboardRootConstantIndex = getDescriptorIndexFromName(pRootSignatureQuad, "billboardsRootConstant");
-
-		billboardRootConstantBlock.genShadow = 1;
+		//Only the compacted visible instances, count comes from the angle compute or the occlusion re-test.
+		if (drawPhase == 1)
+			cmdExecuteIndirect(cmd, pCmdSignatureQuad, 1, pBufferRetestIndirectArgs[gFrameIndex]->buffer, 0, NULL, 0);
+		else if (gUIData.mGeneralSettings.mCompactedDraws)
+			cmdExecuteIndirect(cmd, pCmdSignatureQuad, 1, pBufferQuadIndirectArgs[gFrameIndex]->buffer, 0, NULL, 0);
+		else
+			cmdDrawInstanced(cmd, 6, 0, imposterCount, 0);
+	}
 
-		cmdBeginGpuTimestampQuery(cmd, NULL, "Fill Shadow Depth RT");
-		cmdBeginDebugMarker(cmd, 1, 0, 1, "Fill Depth Buffer");
-		cmdBindPipeline(cmd, pPipelineQuad);
-		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorQuad);
-		cmdBindRenderTargets(cmd, 1, &shadowRT, shadowDepthRT, &clearLoadAction, NULL, NULL, -1, -1);
-		cmdSetViewport(cmd, 0.f, 0.f, (float)mSettings.mWidth, (float)mSettings.mHeight, 0.f, 1.f);
-		cmdSetScissor(cmd, 0, 0, mSettings.mWidth, mSettings.mHeight);
-		cmdBindPushConstants(cmd, pRootSignatureQuad, billboardRootConstantIndex, &billboardRootConstantBlock);
-		cmdBindVertexBuffer(cmd, 1, &pBufferQuadVertex->buffer, &stride, NULL);
-		cmdDrawInstanced(cmd, 6, 0, imposterCount, 0);
+	void DispatchClusterCull(Cmd* cmd)
+	{
+		//Culling tests one cluster per thread, every survivor adds one group to the indirect angle compute,
+		//whose threads then cover that cluster's instances.
+		const uint32_t rootConstantIndex = getDescriptorIndexFromName(pRootSigClusterCull, "clusterCullRootConstant");
+		Buffer* pDispatchArgs = pBufferClusterDispatchArgs[gFrameIndex]->buffer;
+
+		clusterCullRootConstantBlock.imposterCount = imposterCount;
+		clusterCullRootConstantBlock.clusterCount = (imposterCount + ImposterClusterSize - 1) / ImposterClusterSize;
+		clusterCullRootConstantBlock.shadowCasters = billboardRootConstantBlock.genShadow;
+
+		BufferBarrier clusterBarriers[2] = {
+			{ pDispatchArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_COPY_DEST },
+			{ pBufferVisibleClusters[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS } };
+		cmdResourceBarrier(cmd, 1, clusterBarriers, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pDispatchArgs, 0, pBufferClusterDispatchArgsReset->buffer, 0, pBufferClusterDispatchArgsReset->size);
+		clusterBarriers[0] = { pDispatchArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, clusterBarriers, 0, NULL, 0, NULL);
+
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Cluster Cull");
+		cmdBindPipeline(cmd, pPipelineClusterCull);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetClusterCull);
+		cmdBindPushConstants(cmd, pRootSigClusterCull, rootConstantIndex, &clusterCullRootConstantBlock);
+		cmdDispatch(cmd, clusterCullRootConstantBlock.clusterCount / 64 + 1, 1, 1);
 		cmdEndDebugMarker(cmd);
-		cmdEndGpuTimestampQuery(cmd, NULL);
+
+		clusterBarriers[0] = { pDispatchArgs, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		cmdResourceBarrier(cmd, 2, clusterBarriers, 0, NULL, 0, NULL);
 	}
 
-	////////////////////////////////////////////////////////////////////////////////////
-	//									Other Funcs 								  //
-	////////////////////////////////////////////////////////////////////////////////////
-	int GetXZAngle(bool& left)
+	bool OcclusionCullingActive()
 	{
-		//XZ angle computing btw center animating object & camera for debugging purpose.
-		vec3 boPosition = vec3(0.f, 0.f, 0.f);
-		vec3 boDirection = vec3(0.f, 0.f, 1.f);
-		vec3 eyePos = mainCamera->getViewPosition();
-		vec3 boToCam = eyePos - boPosition;
-
-		boDirection.setY(0.f);
-		boToCam.setY(0.f);
+		//Needs the compacted lists, and the depth buffer must come from the culling camera.
+		return gUIData.mGeneralSettings.mOcclusionCulling && gUIData.mGeneralSettings.mCompactedDraws && gUIData.mGeneralSettings.mUsingMainCam;
+	}
 
-		boToCam = normalize(boToCam);
-		boDirection = normalize(boDirection);
+	void ResetOcclusionCounters(Cmd* cmd)
+	{
+		//The retest dispatch args stay writable until the angle compute has appended every candidate.
+		Buffer* pCounters = pBufferOcclusionCounters[gFrameIndex]->buffer;
+		Buffer* pRetestArgs = pBufferRetestIndirectArgs[gFrameIndex]->buffer;
+		Buffer* pRetestDispatchArgs = pBufferRetestDispatchArgs[gFrameIndex]->buffer;
+		BufferBarrier resetBarriers[3] = {
+			{ pCounters, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_DEST },
+			{ pRetestArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_COPY_DEST },
+			{ pRetestDispatchArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_COPY_DEST } };
+		cmdResourceBarrier(cmd, 3, resetBarriers, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pCounters, 0, pBufferOcclusionCountersReset->buffer, 0, pBufferOcclusionCountersReset->size);
+		cmdUpdateBuffer(cmd, pRetestArgs, 0, pBufferQuadIndirectArgsReset->buffer, 0, pBufferQuadIndirectArgsReset->size);
+		cmdUpdateBuffer(cmd, pRetestDispatchArgs, 0, pBufferClusterDispatchArgsReset->buffer, 0, pBufferClusterDispatchArgsReset->size);
+		resetBarriers[0] = { pCounters, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		resetBarriers[1] = { pRetestArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		resetBarriers[2] = { pRetestDispatchArgs, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 3, resetBarriers, 0, NULL, 0, NULL);
+	}
 
-		float cosTheta = dot(boToCam, boDirection);
-		float theta = acos(cosTheta);
-		float angleInDegree = radToDeg(theta);
+	void BuildHiZ(Cmd* cmd)
+	{
+		//Farthest depth per texel down the mip chain, reverse Z so that is the min.
+		cmdBeginGpuTimestampQuery(cmd, NULL, "HiZ Build");
+		const uint32_t rootConstantIndex = getDescriptorIndexFromName(pRootSigHiZBuild, "hizBuildRootConstant");
 
-		vec3 camDir = -boDirection;
-		vec3 targetDir = boPosition - eyePos;
-		vec3 crossResult = cross(camDir, targetDir);
+		RenderTargetBarrier depthBarrier = { pDepthBuffer, RESOURCE_STATE_DEPTH_WRITE, RESOURCE_STATE_SHADER_RESOURCE };
+		TextureBarrier hizBarrier = { pTextureHiZ, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 0, NULL, 1, &hizBarrier, 1, &depthBarrier);
 
-		left = crossResult.getY() > 0.f ? true : false;
+		cmdBindPipeline(cmd, pPipelineHiZBuild);
 
-		if (left)
-			angleInDegree = 180.f + (180.f - angleInDegree);
+		uint32_t srcWidth = pDepthBuffer->mWidth;
+		uint32_t srcHeight = pDepthBuffer->mHeight;
+		for (uint32_t mip = 0; mip < gHiZMipCount; ++mip)
+		{
+			hizBuildRootConstantBlock.srcWidth = srcWidth;
+			hizBuildRootConstantBlock.srcHeight = srcHeight;
+			hizBuildRootConstantBlock.dstWidth = max(pTextureHiZ->mWidth >> mip, 1u);
+			hizBuildRootConstantBlock.dstHeight = max(pTextureHiZ->mHeight >> mip, 1u);
+			hizBuildRootConstantBlock.mipLevel = mip;
+
+			cmdBindDescriptorSet(cmd, mip, pDescriptorSetHiZBuild);
+			cmdBindPushConstants(cmd, pRootSigHiZBuild, rootConstantIndex, &hizBuildRootConstantBlock);
+			cmdDispatch(cmd, hizBuildRootConstantBlock.dstWidth / 8 + 1, hizBuildRootConstantBlock.dstHeight / 8 + 1, 1);
+
+			//Next mip reads this one.
+			hizBarrier = { pTextureHiZ, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS };
+			cmdResourceBarrier(cmd, 0, NULL, 1, &hizBarrier, 0, NULL);
+
+			srcWidth = hizBuildRootConstantBlock.dstWidth;
+			srcHeight = hizBuildRootConstantBlock.dstHeight;
+		}
 
-		return static_cast<int>(angleInDegree);
+		depthBarrier = { pDepthBuffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_DEPTH_WRITE };
+		hizBarrier = { pTextureHiZ, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		cmdResourceBarrier(cmd, 0, NULL, 1, &hizBarrier, 1, &depthBarrier);
+		cmdEndGpuTimestampQuery(cmd, NULL);
 	}
 
-	float GetYAngle()
+	void RetestOccludedImposters(Cmd* cmd)
 	{
-		//Y angle computing btw center animating object & camera for debugging purpose.
+		//Phase two: instances last frame's HiZ rejected, tested again against this frame's.
+		cmdBeginGpuTimestampQuery(cmd, NULL, "Occlusion Retest");
+
+		Buffer* pRetestArgs = pBufferRetestIndirectArgs[gFrameIndex]->buffer;
+		BufferBarrier retestBarriers[3] = {
+			{ pBufferOcclusionCandidates[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS },
+			{ pRetestArgs, RESOURCE_STATE_INDIRECT_ARGUMENT, RESOURCE_STATE_UNORDERED_ACCESS },
+			{ pBufferRetestIndices[gFrameIndex]->buffer, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS } };
+		cmdResourceBarrier(cmd, 3, retestBarriers, 0, NULL, 0, NULL);
+
+		//Group count comes from the candidates the angle compute appended, not the whole crowd.
+		cmdBindPipeline(cmd, pPipelineOcclusionRetest);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetOcclusionRetest);
+		cmdExecuteIndirect(cmd, pCmdSignatureRetestDispatch, 1, pBufferRetestDispatchArgs[gFrameIndex]->buffer, 0, NULL, 0);
+
+		retestBarriers[0] = { pBufferOcclusionCounters[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS };
+		retestBarriers[1] = { pRetestArgs, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_INDIRECT_ARGUMENT };
+		retestBarriers[2] = { pBufferRetestIndices[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE };
+		cmdResourceBarrier(cmd, 3, retestBarriers, 0, NULL, 0, NULL);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	void CopyOcclusionCounters(Cmd* cmd)
+	{
+		//Culling stats into this frame's readback slot.
+		Buffer* pCounters = pBufferOcclusionCounters[gFrameIndex]->buffer;
+		BufferBarrier countersBarrier = { pCounters, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE };
+		cmdResourceBarrier(cmd, 1, &countersBarrier, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pBufferOcclusionReadback[gFrameIndex]->buffer, 0, pCounters, 0, pBufferOcclusionCounters[gFrameIndex]->size);
+		countersBarrier = { pCounters, RESOURCE_STATE_COPY_SOURCE, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, &countersBarrier, 0, NULL, 0, NULL);
+		gOcclusionReadbackReady[gFrameIndex] = true;
+	}
+
+	void CopyAngleBinUsage(Cmd* cmd)
+	{
+		//Copy view usage into this frame's readback slot, read on CPU once the frame fence signaled.
+		BufferBarrier usageBarrier = { pBufferAngleBinUsage->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE };
+		cmdResourceBarrier(cmd, 1, &usageBarrier, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pBufferAngleBinReadback[gFrameIndex]->buffer, 0, pBufferAngleBinUsage->buffer, 0, pBufferAngleBinUsage->size);
+		usageBarrier = { pBufferAngleBinUsage->buffer, RESOURCE_STATE_COPY_SOURCE, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, &usageBarrier, 0, NULL, 0, NULL);
+
+		gCaptureScheduler.mReadbackStamps[gFrameIndex] = gCaptureScheduler.mFrameStamp;
+	}
+
+	void DispatchAnimAccelCompute(Cmd* cmd)
+	{
+		//Skinning accel dispatch.
+
+		//Before dispatch, update joint modelmats, the pose cache path samples on the GPU instead.
+		if (!UsingPoseCache())
+		{
+			Buffer* pModelMats = pBufferJointModelMats[gFrameIndex]->buffer;
+			const uint64_t modelMatsSize = gStickFigureAnimObject->mRig->mNumJoints * sizeof(mat4);
+			WriteUpload(gUploadJointModelMats, gStickFigureAnimObject->mJointModelMats.begin(), modelMatsSize);
+			BufferBarrier modelMatsBarrier = { pModelMats, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_DEST };
+			cmdResourceBarrier(cmd, 1, &modelMatsBarrier, 0, NULL, 0, NULL);
+			cmdUpdateBuffer(cmd, pModelMats, 0, gUploadRing.pBuffer, GetUploadOffset(gUploadJointModelMats), modelMatsSize);
+			modelMatsBarrier = { pModelMats, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_UNORDERED_ACCESS };
+			cmdResourceBarrier(cmd, 1, &modelMatsBarrier, 0, NULL, 0, NULL);
+		}
+
+		const uint32_t rootConstantIndex = getDescriptorIndexFromName(pRootSigAnimAccelerator, "animAccelRootConstant");
+		animAccelRootConstantBlock.jointCount = gStickFigureAnimObject->mRig->mNumJoints;
+		animAccelRootConstantBlock.boneCount = pGeomData->mJointCount;
+		animAccelRootConstantBlock.levelCount = gJointLevelCount;
+		animAccelRootConstantBlock.usePoseCache = UsingPoseCache() ? 1 : 0;
+		animAccelRootConstantBlock.poseFrameCount = gPoseCache.mFrameCount;
+		animAccelRootConstantBlock.clipDuration = gPoseCache.mDuration;
+		animAccelRootConstantBlock.animationTime = gUIData.mClip.mAnimationTime;
+
+		//Accelerator writes the final palette, skinning reads it on the GPU with no CPU round trip.
+		Buffer* pPalette = pBufferBonePalette[gFrameIndex]->buffer;
+		BufferBarrier paletteBarrier = { pPalette, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, &paletteBarrier, 0, NULL, 0, NULL);
+
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "AnimAccel Computation");
+
+		cmdBindPipeline(cmd, pPipelineAnimAccelerator);
+		cmdBindDescriptorSet(cmd, 0, pDescriptorSetAnimAccelerator[0]);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetAnimAccelerator[1]);
+		cmdBindPushConstants(cmd, pRootSigAnimAccelerator, rootConstantIndex, &animAccelRootConstantBlock);
+		//The single posed rig, its threads walk the hierarchy a depth level at a time.
+		//Many characters batch in the near field palette compute, one group per promoted instance.
+		cmdDispatch(cmd, 1, 1, 1);
+
+		cmdEndDebugMarker(cmd);
+
+		//World mats go to this frame's readback slot, the CPU sees them once its fence signaled.
+		Buffer* pWorldMats = pBufferJointWorldMats[gFrameIndex]->buffer;
+		BufferBarrier accelBarriers[2] = {
+			{ pPalette, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER },
+			{ pWorldMats, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_COPY_SOURCE } };
+		cmdResourceBarrier(cmd, 2, accelBarriers, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pBufferJointWorldMatsReadback[gFrameIndex]->buffer, 0, pWorldMats, 0, pBufferJointWorldMats[gFrameIndex]->size);
+		accelBarriers[1] = { pWorldMats, RESOURCE_STATE_COPY_SOURCE, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, &accelBarriers[1], 0, NULL, 0, NULL);
+		gJointWorldMatsReadbackReady[gFrameIndex] = true;
+	}
+
+	uint64_t BonePaletteSize()
+	{
+		//Bytes of the used bones only, the buffers are sized for MAX_NUM_BONES mat4s.
+		return (uint64_t)pGeomData->mJointCount * gBonePaletteRows[gBonePaletteFormat] * sizeof(vec4);
+	}
+
+	void UpdateBonePalette()
+	{
+		BuildBonePalette(gBonePaletteFormat, gStickFigureAnimObject->mJointWorldMats.begin(), gUniformDataBones.mBoneRows);
+		WriteUpload(gUploadBones, &gUniformDataBones, BonePaletteSize());
+	}
+
+	void UploadBonePalette(Cmd* cmd)
+	{
+		//CPU posed palette into the buffer skinning reads.
+		Buffer* pPalette = pBufferBonePalette[gFrameIndex]->buffer;
+		BufferBarrier paletteBarrier = { pPalette, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_COPY_DEST };
+		cmdResourceBarrier(cmd, 1, &paletteBarrier, 0, NULL, 0, NULL);
+		cmdUpdateBuffer(cmd, pPalette, 0, gUploadRing.pBuffer, GetUploadOffset(gUploadBones), BonePaletteSize());
+		paletteBarrier = { pPalette, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+		cmdResourceBarrier(cmd, 1, &paletteBarrier, 0, NULL, 0, NULL);
+	}
+
+	bool UsingPoseCache()
+	{
+		return gUIData.mGeneralSettings.mUsePoseCache && !gUIData.mGeneralSettings.mShowBindPose;
+	}
+
+	bool GpuAnimationPalette()
+	{
+		return !gUIData.mGeneralSettings.mShowBindPose && gUIData.mGeneralSettings.mOptimizeAnimSim;
+	}
+
+	void DispatchSkinningCompute(Cmd* cmd, ProfileToken token)
+	{
+		//Skin every vertex of the current pose once, capture views and main draw of this frame reuse it.
+		cmdBeginGpuTimestampQuery(cmd, token, "Skinning Compute");
+		RecordSkinningCompute(cmd);
+		cmdEndGpuTimestampQuery(cmd, token);
+	}
+
+	void RecordSkinningCompute(Cmd* cmd)
+	{
+		const uint32_t skinningConstantIndex = getDescriptorIndexFromName(pRootSigSkinningCompute, "skinningRootConstant");
+
+		skinningRootConstantBlock.vertexCount = pGeom->mVertexCount;
+		skinningRootConstantBlock.inputStride = pGeom->mVertexStrides[0];
+
+		BufferBarrier skinnedVertexBarrier = { pBufferSkinnedVertices[gFrameIndex]->buffer, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_UNORDERED_ACCESS };
+		cmdResourceBarrier(cmd, 1, &skinnedVertexBarrier, 0, NULL, 0, NULL);
+
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Skinning Computation");
+		cmdBindPipeline(cmd, pPipelineSkinningCompute);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetSkinningCompute);
+		cmdBindPushConstants(cmd, pRootSigSkinningCompute, skinningConstantIndex, &skinningRootConstantBlock);
+		cmdDispatch(cmd, pGeom->mVertexCount / 64 + 1, 1, 1);
+		cmdEndDebugMarker(cmd);
+
+		skinnedVertexBarrier = { pBufferSkinnedVertices[gFrameIndex]->buffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+		cmdResourceBarrier(cmd, 1, &skinnedVertexBarrier, 0, NULL, 0, NULL);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
+	//									RenderTargets Funcs							  //
+	////////////////////////////////////////////////////////////////////////////////////
+	void CaptureToRT(Cmd* cmd_)
+	{
+		//Capture skinning animation to atlas slices.
+		cmdBeginGpuTimestampQuery(cmd_, NULL, "Generate Capture of SkinnedMesh");
+		RecordImposterCapture(cmd_);
+		cmdEndGpuTimestampQuery(cmd_, NULL);
+	}
+
+	void RecordImposterCapture(Cmd* cmd_)
+	{
+		//Draws the scheduled views, shared by the per-frame capture and the bake.
+		MatrixBlock mvpMatrixBlock;
+		mvpMatrixBlock.mProjMat = imposterProjMatrix;
+		mvpMatrixBlock.mViewMat = imposterViewMatrix;
+		mvpMatrixBlock.mToWorldMat = mat4::identity();
+
+		RenderTarget* renderTarget = gImposterAtlas.pColor;
+
+		const uint32_t refreshCount = gCaptureScheduler.mRefreshCount;
+		const bool fullRefresh = refreshCount == gImposterAtlas.mViewCount;
+
+		//Single instanced draw over all atlas slices, needs the pre-skinned vertices and the layer select.
+		if (gUIData.mGeneralSettings.mSinglePassCapture && gPosedMeshReady && gMultiViewCaptureSupported)
+		{
+			const uint32_t stride = SkinnedVertexStride;
+			const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignaturePosedMeshMultiView, "transformRootConstant");
+
+			//Partial refresh keeps the other slices, so only the scheduled ones get cleared.
+			LoadActionsDesc captureLoadAction = clearLoadAction;
+			if (!fullRefresh)
+			{
+				for (uint32_t i = 0; i < refreshCount; ++i)
+				{
+					uint32_t slice = gCaptureScheduler.mRefreshViews[i];
+					cmdBindRenderTargets(cmd_, 1, &renderTarget, gImposterAtlas.pDepth, &clearLoadAction, &slice, NULL, slice, 0);
+				}
+				cmdBindRenderTargets(cmd_, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
+
+				captureLoadAction.mLoadActionsColor[0] = LOAD_ACTION_LOAD;
+				captureLoadAction.mLoadActionDepth = LOAD_ACTION_LOAD;
+			}
+
+			cmdBindRenderTargets(cmd_, 1, &renderTarget, gImposterAtlas.pDepth, &captureLoadAction, NULL, NULL, -1, -1);
+			cmdSetViewport(cmd_, 0.f, 0.f, (float)gImposterAtlas.mViewWidth, (float)gImposterAtlas.mViewHeight, 0.f, 1.f);
+			cmdSetScissor(cmd_, 0, 0, gImposterAtlas.mViewWidth, gImposterAtlas.mViewHeight);
+			cmdBindPipeline(cmd_, pPipelinePosedMeshMultiView);
+			cmdBindDescriptorSet(cmd_, 0, pDescriptorSetPosedMeshMultiView[0]);
+			cmdBindDescriptorSet(cmd_, gFrameIndex, pDescriptorSetPosedMeshMultiView[1]);
+			cmdBindPushConstants(cmd_, pRootSignaturePosedMeshMultiView, transformRootConstantIndex, &mvpMatrixBlock);
+			cmdBindVertexBuffer(cmd_, 1, &pBufferSkinnedVertices[gFrameIndex]->buffer, &stride, NULL);
+			cmdBindIndexBuffer(cmd_, pGeom->pIndexBuffer, pGeom->mIndexType, NULL);
+			cmdDrawIndexedInstanced(cmd_, pGeom->mIndexCount, 0, refreshCount, 0, 0);
+			cmdBindRenderTargets(cmd_, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
+			return;
+		}
+
+		for (uint32_t i = 0; i < refreshCount; ++i)
+		{
+			uint32_t slice = gCaptureScheduler.mRefreshViews[i];
+
+			cmdBindRenderTargets(cmd_, 1, &renderTarget, gImposterAtlas.pDepth, &clearLoadAction, &slice, NULL, slice, 0);
+			cmdSetViewport(cmd_, 0.f, 0.f, (float)gImposterAtlas.mViewWidth, (float)gImposterAtlas.mViewHeight, 0.f, 1.f);
+			cmdSetScissor(cmd_, 0, 0, gImposterAtlas.mViewWidth, gImposterAtlas.mViewHeight);
+			mvpMatrixBlock.mViewMat = imposterCaptureViewMats[slice];
+			mvpMatrixBlock.mToWorldMat = mat4::identity();
+			BindCharacterMesh(cmd_, &mvpMatrixBlock);
+			cmdDrawIndexed(cmd_, pGeom->mIndexCount, 0, 0);
+			cmdBindRenderTargets(cmd_, 0, NULL, NULL, NULL, NULL, NULL, -1, -1);
+		}
+	}
+
+	void BindCharacterMesh(Cmd* cmd_, const MatrixBlock* pMatrixBlock)
+	{
+		//Pre-skinned vertices only need a rigid transform, otherwise skin in the vertex shader.
+		if (gPosedMeshReady)
+		{
+			const uint32_t stride = SkinnedVertexStride;
+			const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignaturePosedMesh, "transformRootConstant");
+
+			cmdBindPipeline(cmd_, pPipelinePosedMesh);
+			cmdBindDescriptorSet(cmd_, 0, pDescriptorSetPosedMesh);
+			cmdBindPushConstants(cmd_, pRootSignaturePosedMesh, transformRootConstantIndex, pMatrixBlock);
+			cmdBindVertexBuffer(cmd_, 1, &pBufferSkinnedVertices[gFrameIndex]->buffer, &stride, NULL);
+		}
+		else
+		{
+			const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignatureSkinning, "transformRootConstant");
+
+			cmdBindPipeline(cmd_, pPipelineSkinning);
+			cmdBindDescriptorSet(cmd_, 0, pDescriptorSetSkinning[0]);
+			cmdBindDescriptorSet(cmd_, gFrameIndex, pDescriptorSetSkinning[1]);
+			cmdBindPushConstants(cmd_, pRootSignatureSkinning, transformRootConstantIndex, pMatrixBlock);
+			cmdBindVertexBuffer(cmd_, 1, &pGeom->pVertexBuffers[0], pGeom->mVertexStrides, NULL);
+		}
+		cmdBindIndexBuffer(cmd_, pGeom->pIndexBuffer, pGeom->mIndexType, NULL);
+	}
+
+	void BindDefaultRT(Cmd* cmd_, uint32_t swapChainIndex)
+	{
+		//Back to default swapchain rtv.
+		RenderTarget* pRenderTarget = pSwapChain->ppRenderTargets[swapChainIndex];
+
+		cmdBindRenderTargets(cmd_, 1, &pRenderTarget, pDepthBuffer, &clearLoadAction, NULL, NULL, -1, -1);
+		cmdSetViewport(cmd_, 0.f, 0.f, (float)pRenderTarget->mWidth, (float)pRenderTarget->mHeight, 0.f, 1.f);
+		cmdSetScissor(cmd_, 0, 0, pRenderTarget->mWidth, pRenderTarget->mHeight);
+	}
+
+	
+	////////////////////////////////////////////////////////////////////////////////////
+	//									Render Funcs								  //
+	////////////////////////////////////////////////////////////////////////////////////
+	void RenderQuads(Cmd* cmd, uint32_t drawPhase)
+	{
+		//Rendering Quads with capturing, phase 1 draws the instances recovered by the occlusion re-test.
+		constexpr uint32_t stride = sizeof(float) * 6;
+		const uint32_t billboardRootConstantIndex = getDescriptorIndexFromName(pRootSignatureQuad, "billboardsRootConstant");
+
+		//Local copy, the shadow pass may be recording on a worker at the same time.
+		billboardsRootConstant quadConstants = billboardRootConstantBlock;
+		quadConstants.showQuads = gUIData.mGeneralSettings.mShowQuads ? 1 : 0;
+		quadConstants.genShadow = 0;
+		quadConstants.drawPhase = (int)drawPhase;
+		SetImposterLookupConstants(quadConstants);
+
+		cmdBeginGpuTimestampQuery(cmd, NULL, drawPhase == 0 ? "Render Quads" : "Render Quads Recovered");
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Quad");
+		cmdBindPushConstants(cmd, pRootSignatureQuad, billboardRootConstantIndex, &quadConstants);
+		cmdBindPipeline(cmd, pPipelineQuad);
+		cmdBindDescriptorSet(cmd, 0, pDescriptorSetImposterHeap);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorQuad);
+		cmdBindVertexBuffer(cmd, 1, &pBufferQuadVertex->buffer, &stride, NULL);
+		DrawImposterQuads(cmd, drawPhase);
+		cmdEndDebugMarker(cmd);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	void RenderPlane(Cmd* cmd)
+	{
+		//RenderPlane with scene's depth infos.
+		const uint32_t stride = sizeof(float) * 6;
+		const uint32_t constantIndex = getDescriptorIndexFromName(pRootSignaturePlane, "lightPOVRootConstant");
+
+		struct Data{
+			mat4 lightProjMat;
+			int drawShadow;
+		}data;
+
+		data.lightProjMat = lightProjMat;
+		data.drawShadow = gUIData.mGeneralSettings.mDrawShadows == true ? 1 : 0;
+		int drawShadows = gUIData.mGeneralSettings.mDrawShadows ? 1 : 0;
+
+		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Plane");
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Plane");
+		cmdBindPipeline(cmd, pPlaneDrawPipeline);
+		cmdBindPushConstants(cmd, pRootSignaturePlane, constantIndex, &data);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSet);
+		cmdBindVertexBuffer(cmd, 1, &pBufferPlaneVertex->buffer, &stride, NULL);
+		cmdDraw(cmd, 6, 0);
+		cmdEndDebugMarker(cmd);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	void RenderAnimation(Cmd* cmd)
+	{
+		//Rendering Skinning anims.
+		MatrixBlock data;
+		data.mProjMat = projViewModelMatrices.mProjMat;
+		data.mViewMat = projViewModelMatrices.mViewMat;
+		data.mToWorldMat = mat4::identity();
+
+		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Skinning Anim");
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Skinned Mesh");
+		BindCharacterMesh(cmd, &data);
+		cmdDrawIndexed(cmd, pGeom->mIndexCount, 0, 0);
+		cmdEndDebugMarker(cmd);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	void RenderNearField(Cmd* cmd)
+	{
+		//Every promoted instance in one instanced skinned draw, the palettes already carry its position.
+		if (!NearFieldActive())
+			return;
+
+		MatrixBlock data;
+		data.mProjMat = projViewModelMatrices.mProjMat;
+		data.mViewMat = projViewModelMatrices.mViewMat;
+		data.mToWorldMat = mat4::identity();
+		const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignatureSkinningInstanced, "transformRootConstant");
+
+		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Near Field");
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Near Field");
+		cmdBindPipeline(cmd, pPipelineSkinningInstanced);
+		cmdBindDescriptorSet(cmd, 0, pDescriptorSetSkinningInstanced[0]);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetSkinningInstanced[1]);
+		cmdBindPushConstants(cmd, pRootSignatureSkinningInstanced, transformRootConstantIndex, &data);
+		cmdBindVertexBuffer(cmd, 1, &pGeom->pVertexBuffers[0], pGeom->mVertexStrides, NULL);
+		cmdBindIndexBuffer(cmd, pGeom->pIndexBuffer, pGeom->mIndexType, NULL);
+		cmdExecuteIndirect(cmd, pCmdSignatureNearField, 1, pBufferNearFieldArgs[gFrameIndex]->buffer, 0, NULL, 0);
+		cmdEndDebugMarker(cmd);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	void RenderVatMeshes(Cmd* cmd)
+	{
+		//Mid field instances replay the baked vertex animation at their own phase, no bone math.
+		if (!VatActive())
+			return;
+
+		vatBlock.mVertexCount = pGeom->mVertexCount;
+		vatBlock.mFrameCount = VatFrameCount;
+		vatBlock.mClipDuration = gClipController->mDuration;
+		vatBlock.mAnimationTime = gUIData.mClip.mAnimationTime;
+		vatBlock.mPhaseSpread = gUIData.mGeneralSettings.phaseSpread;
+		vatBlock.mImposter360 = gUIData.mGeneralSettings.mUsing360Imposter ? 1 : 0;
+		WriteUpload(gUploadVatBlock, &vatBlock, sizeof(vatBlock));
+
+		MatrixBlock data;
+		data.mProjMat = projViewModelMatrices.mProjMat;
+		data.mViewMat = projViewModelMatrices.mViewMat;
+		data.mToWorldMat = mat4::identity();
+		const uint32_t transformRootConstantIndex = getDescriptorIndexFromName(pRootSignatureVatMesh, "transformRootConstant");
+
+		cmdBeginGpuTimestampQuery(cmd, NULL, "Render Vertex Animation");
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Draw Vertex Animation");
+		cmdBindPipeline(cmd, pPipelineVatMesh);
+		cmdBindDescriptorSet(cmd, 0, pDescriptorSetVatMesh[0]);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorSetVatMesh[1]);
+		cmdBindPushConstants(cmd, pRootSignatureVatMesh, transformRootConstantIndex, &data);
+		cmdBindIndexBuffer(cmd, pGeom->pIndexBuffer, pGeom->mIndexType, NULL);
+		cmdExecuteIndirect(cmd, pCmdSignatureVat, 1, pBufferVatArgs[gFrameIndex]->buffer, 0, NULL, 0);
+		cmdEndDebugMarker(cmd);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
+	//									Shadow Funcs								  //
+	////////////////////////////////////////////////////////////////////////////////////
+	void FillShadowDepthRT(Cmd* cmd)
+	{
+		cmdBeginGpuTimestampQuery(cmd, NULL, "Fill Shadow Depth RT");
+		RecordShadowDepth(cmd);
+		cmdEndGpuTimestampQuery(cmd, NULL);
+	}
+
+	void RecordShadowDepth(Cmd* cmd)
+	{
+		constexpr uint32_t stride = sizeof(float) * 6;
+
+		const uint32_t billboardRootConstantIndex = getDescriptorIndexFromName(pRootSignatureQuad, "billboardsRootConstant");
+
+		//Casters come from the light's list, the compacted one was culled against the main camera.
+		billboardsRootConstant shadowConstants = billboardRootConstantBlock;
+		shadowConstants.genShadow = 1;
+		shadowConstants.drawPhase = 0;
+		shadowConstants.compactedDraw = 0;
+		SetImposterLookupConstants(shadowConstants);
+
+		cmdBeginDebugMarker(cmd, 1, 0, 1, "Fill Depth Buffer");
+		cmdBindPipeline(cmd, pPipelineQuadShadow);
+		cmdBindDescriptorSet(cmd, 0, pDescriptorSetImposterHeap);
+		cmdBindDescriptorSet(cmd, gFrameIndex, pDescriptorQuad);
+		cmdBindRenderTargets(cmd, 0, NULL, shadowDepthRT, &clearLoadAction, NULL, NULL, -1, -1);
+		cmdSetViewport(cmd, 0.f, 0.f, (float)mSettings.mWidth, (float)mSettings.mHeight, 0.f, 1.f);
+		cmdSetScissor(cmd, 0, 0, mSettings.mWidth, mSettings.mHeight);
+		cmdBindPushConstants(cmd, pRootSignatureQuad, billboardRootConstantIndex, &shadowConstants);
+		cmdBindVertexBuffer(cmd, 1, &pBufferQuadVertex->buffer, &stride, NULL);
+		cmdExecuteIndirect(cmd, pCmdSignatureQuad, 1, pBufferShadowIndirectArgs[gFrameIndex]->buffer, 0, NULL, 0);
+		cmdEndDebugMarker(cmd);
+	}
+
+	void RecordCapturePass(Cmd* cmd, bool gpuTimestamps)
+	{
+		beginCmd(cmd);
+
+		if (!gFrameGraph.mPasses[FRAME_GRAPH_PASS_CAPTURE].mCulled)
+		{
+			//Atlas to render target, the main pass turns it back into a texture.
+			CmdFrameGraphBarriers(cmd, FRAME_GRAPH_PASS_CAPTURE);
+
+			//Capture to rendertarget of skinning anims.
+			if (gpuTimestamps)
+				CaptureToRT(cmd);
+			else
+				RecordImposterCapture(cmd);
+		}
+
+		endCmd(cmd);
+	}
+
+	void RecordShadowPass(Cmd* cmd, bool gpuTimestamps)
+	{
+		beginCmd(cmd);
+
+		if (!gFrameGraph.mPasses[FRAME_GRAPH_PASS_SHADOW].mCulled)
+		{
+			CmdFrameGraphBarriers(cmd, FRAME_GRAPH_PASS_SHADOW);
+
+			//Store depth values of the scene.
+			if (gpuTimestamps)
+				FillShadowDepthRT(cmd);
+			else
+				RecordShadowDepth(cmd);
+		}
+
+		endCmd(cmd);
+	}
+
+	static void RecordPassTask(void* pUserData, uint64_t index)
+	{
+		//Index 0 records the capture list, 1 the shadow list.
+		PassRecordTaskData* pData = (PassRecordTaskData*)pUserData;
+		const uint32_t list = RECORD_LIST_CAPTURE + (uint32_t)index;
+		if (list == RECORD_LIST_CAPTURE)
+			pData->pApp->RecordCapturePass(pData->ppCmds[list], false);
+		else
+			pData->pApp->RecordShadowPass(pData->ppCmds[list], false);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
+	//									Frame Graph Funcs							  //
+	////////////////////////////////////////////////////////////////////////////////////
+	void AddFrameGraphAccess(uint32_t pass, uint32_t resource, ResourceState state, bool write)
+	{
+		FrameGraphPass& graphPass = gFrameGraph.mPasses[pass];
+		ASSERT(graphPass.mAccessCount < MaxFrameGraphAccesses);
+		graphPass.mAccesses[graphPass.mAccessCount++] = { resource, state, write };
+	}
+
+	void DeclareFrameGraph(RenderTarget* pBackBuffer)
+	{
+		//Resources, in the state they are created in.
+		FrameGraphResource* pResources = gFrameGraph.mResources;
+		pResources[FRAME_GRAPH_RESOURCE_ATLAS_COLOR] = { gImposterAtlas.pColor, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE, true };
+		pResources[FRAME_GRAPH_RESOURCE_SHADOW_DEPTH] = { shadowDepthRT, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_SHADER_RESOURCE, false };
+		pResources[FRAME_GRAPH_RESOURCE_BACK_BUFFER] = { pBackBuffer, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT, true };
+
+		for (uint32_t i = 0; i < FRAME_GRAPH_PASS_COUNT; ++i)
+			gFrameGraph.mPasses[i] = {};
+
+		//Baked imposters need no capture at all, live ones only on capture ticks.
+		const bool baked = UsingBakedImposters();
+		FrameGraphPass& capturePass = gFrameGraph.mPasses[FRAME_GRAPH_PASS_CAPTURE];
+		capturePass.pName = "Capture";
+		capturePass.mEnabled = !baked && gCaptureTick;
+		AddFrameGraphAccess(FRAME_GRAPH_PASS_CAPTURE, FRAME_GRAPH_RESOURCE_ATLAS_COLOR, RESOURCE_STATE_RENDER_TARGET, true);
+
+		FrameGraphPass& shadowPass = gFrameGraph.mPasses[FRAME_GRAPH_PASS_SHADOW];
+		shadowPass.pName = "Shadow";
+		shadowPass.mEnabled = true;
+		AddFrameGraphAccess(FRAME_GRAPH_PASS_SHADOW, FRAME_GRAPH_RESOURCE_SHADOW_DEPTH, RESOURCE_STATE_DEPTH_WRITE, true);
+		//Live imposter quads cast their shadow from the atlas the capture just wrote.
+		if (!baked)
+			AddFrameGraphAccess(FRAME_GRAPH_PASS_SHADOW, FRAME_GRAPH_RESOURCE_ATLAS_COLOR, RESOURCE_STATE_SHADER_RESOURCE, false);
+
+		//The plane samples the shadow depth only when shadows are drawn, otherwise the shadow pass gets culled.
+		FrameGraphPass& mainPass = gFrameGraph.mPasses[FRAME_GRAPH_PASS_MAIN];
+		mainPass.pName = "Main";
+		mainPass.mEnabled = true;
+		mainPass.mSideEffects = true;
+		if (!baked)
+			AddFrameGraphAccess(FRAME_GRAPH_PASS_MAIN, FRAME_GRAPH_RESOURCE_ATLAS_COLOR, RESOURCE_STATE_SHADER_RESOURCE, false);
+		if (gUIData.mGeneralSettings.mDrawShadows)
+			AddFrameGraphAccess(FRAME_GRAPH_PASS_MAIN, FRAME_GRAPH_RESOURCE_SHADOW_DEPTH, RESOURCE_STATE_SHADER_RESOURCE, false);
+		AddFrameGraphAccess(FRAME_GRAPH_PASS_MAIN, FRAME_GRAPH_RESOURCE_BACK_BUFFER, RESOURCE_STATE_RENDER_TARGET, true);
+	}
+
+	void CompileFrameGraph()
+	{
+		//Cull back to front, a pass lives if it has side effects or writes what outlives the frame or a live pass reads.
+		bool readLater[FRAME_GRAPH_RESOURCE_COUNT] = {};
+		gFrameGraph.mCulledCount = 0;
+		for (int32_t p = FRAME_GRAPH_PASS_COUNT - 1; p >= 0; --p)
+		{
+			FrameGraphPass& pass = gFrameGraph.mPasses[p];
+			bool live = pass.mSideEffects;
+			for (uint32_t a = 0; a < pass.mAccessCount && !live; ++a)
+			{
+				const FrameGraphAccess& access = pass.mAccesses[a];
+				if (access.mWrite && (gFrameGraph.mResources[access.mResource].mPersistent || readLater[access.mResource]))
+					live = true;
+			}
+
+			pass.mCulled = !pass.mEnabled || !live;
+			if (pass.mCulled)
+			{
+				++gFrameGraph.mCulledCount;
+				continue;
+			}
+
+			for (uint32_t a = 0; a < pass.mAccessCount; ++a)
+			{
+				if (!pass.mAccesses[a].mWrite)
+					readLater[pass.mAccesses[a].mResource] = true;
+			}
+		}
+
+		//Front to back, every live pass gets all its transitions in one batch.
+		gFrameGraph.mBarrierCount = 0;
+		for (uint32_t p = 0; p < FRAME_GRAPH_PASS_COUNT; ++p)
+		{
+			FrameGraphPass& pass = gFrameGraph.mPasses[p];
+			pass.mBarrierCount = 0;
+			if (pass.mCulled)
+				continue;
+
+			for (uint32_t a = 0; a < pass.mAccessCount; ++a)
+			{
+				const FrameGraphAccess& access = pass.mAccesses[a];
+				FrameGraphResource& resource = gFrameGraph.mResources[access.mResource];
+				if (resource.mState == access.mState)
+					continue;
+
+				pass.mBarriers[pass.mBarrierCount++] = { resource.pRenderTarget, resource.mState, access.mState };
+				resource.mState = access.mState;
+			}
+			gFrameGraph.mBarrierCount += pass.mBarrierCount;
+		}
+
+		gFrameGraph.mFinalBarrierCount = 0;
+		for (uint32_t r = 0; r < FRAME_GRAPH_RESOURCE_COUNT; ++r)
+		{
+			FrameGraphResource& resource = gFrameGraph.mResources[r];
+			if (resource.mState == resource.mInitialState)
+				continue;
+
+			gFrameGraph.mFinalBarriers[gFrameGraph.mFinalBarrierCount++] = { resource.pRenderTarget, resource.mState, resource.mInitialState };
+			resource.mState = resource.mInitialState;
+		}
+		gFrameGraph.mBarrierCount += gFrameGraph.mFinalBarrierCount;
+	}
+
+	void CmdFrameGraphBarriers(Cmd* cmd, uint32_t pass)
+	{
+		const FrameGraphPass& graphPass = gFrameGraph.mPasses[pass];
+		if (graphPass.mBarrierCount)
+			cmdResourceBarrier(cmd, 0, NULL, 0, NULL, graphPass.mBarrierCount, (RenderTargetBarrier*)graphPass.mBarriers);
+	}
+
+	void CmdFrameGraphFinalBarriers(Cmd* cmd)
+	{
+		if (gFrameGraph.mFinalBarrierCount)
+			cmdResourceBarrier(cmd, 0, NULL, 0, NULL, gFrameGraph.mFinalBarrierCount, gFrameGraph.mFinalBarriers);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
+	//									Bake Funcs									  //
+	////////////////////////////////////////////////////////////////////////////////////
+	bool UsingBakedImposters()
+	{
+		return gUIData.mGeneralSettings.mUseBakedImposters && pImposterBakeTextures[gLiveArchetype] != NULL;
+	}
+
+	void SetImposterLookupConstants(billboardsRootConstant& constants)
+	{
+		//Baked slices are frame major, the billboard VS adds each instance's phase to the clip frame
+		//and picks layer = (frame % frameCount) * viewCount + view, from heap slot
+		//archetype + bakedFlipbook * MaxImposterArchetypes with that slot's imposterHeapLayouts entry.
+		const ImposterBakeHeader& header = gImposterBakeHeader;
+		const bool baked = UsingBakedImposters();
+
+		constants.bakedFlipbook = baked ? 1 : 0;
+		constants.bakeFrame = baked ? gUIData.mClip.mAnimationTime * header.mSampleRate : 0.f;
+		constants.phaseSpread = baked ? gUIData.mGeneralSettings.phaseSpread : 0.f;
+
+		//Angle compute picks the view from the full 3D direction, slots in an octahedral layout can blend the 3 nearest views.
+		constants.blendViews = gUIData.mGeneralSettings.mBlendViews ? 1 : 0;
+	}
+
+	uint32_t CompressImposterSlice(const uint32_t* pTexels, uint32_t texelCount, uint32_t* pOut)
+	{
+		//Zero run length, then literal count and literals, repeated. Returns written words.
+		uint32_t written = 0;
+		uint32_t i = 0;
+
+		while (i < texelCount)
+		{
+			uint32_t zeroRun = 0;
+			while (i + zeroRun < texelCount && pTexels[i + zeroRun] == 0)
+				++zeroRun;
+			i += zeroRun;
+
+			uint32_t literalCount = 0;
+			while (i + literalCount < texelCount && pTexels[i + literalCount] != 0)
+				++literalCount;
+
+			pOut[written++] = zeroRun;
+			pOut[written++] = literalCount;
+			memcpy(pOut + written, pTexels + i, literalCount * sizeof(uint32_t));
+			written += literalCount;
+			i += literalCount;
+		}
+
+		return written;
+	}
+
+	bool DecompressImposterSlice(const uint32_t* pIn, uint64_t wordCount, uint32_t texelCount, uint32_t* pTexels)
+	{
+		//Fails when the slice ends early or a run would write past the last texel.
+		uint64_t read = 0;
+		uint32_t i = 0;
+
+		while (i < texelCount)
+		{
+			if (wordCount - read < 2)
+				return false;
+
+			uint32_t zeroRun = pIn[read++];
+			uint32_t literalCount = pIn[read++];
+			if (zeroRun > texelCount - i)
+				return false;
+
+			memset(pTexels + i, 0, zeroRun * sizeof(uint32_t));
+			i += zeroRun;
+
+			if (literalCount > texelCount - i || literalCount > wordCount - read)
+				return false;
+
+			memcpy(pTexels + i, pIn + read, literalCount * sizeof(uint32_t));
+			read += literalCount;
+			i += literalCount;
+		}
+
+		return true;
+	}
+
+	bool ValidateImposterBake(const uint8_t* pBytes, uint64_t fileSize)
+	{
+		//Header and slice table only, the slice contents are checked while decompressing.
+		if (fileSize < sizeof(ImposterBakeHeader))
+			return false;
+
+		const ImposterBakeHeader* pHeader = (const ImposterBakeHeader*)pBytes;
+		if (pHeader->mMagic != ImposterBakeMagic || pHeader->mVersion != ImposterBakeVersion ||
+			TinyImageFormat_BitSizeOfBlock((TinyImageFormat)pHeader->mFormat) != 32)
+			return false;
+
+		if (pHeader->mCompression != IMPOSTER_BAKE_COMPRESSION_NONE && pHeader->mCompression != IMPOSTER_BAKE_COMPRESSION_ZERO_RLE)
+			return false;
+
+		if (pHeader->mViewWidth == 0 || pHeader->mViewWidth > MaxImposterBakeViewSize ||
+			pHeader->mViewHeight == 0 || pHeader->mViewHeight > MaxImposterBakeViewSize)
+			return false;
+
+		//The view count has to be the one the layout's angle lookup produces.
+		if (pHeader->mViewLayout >= IMPOSTER_VIEW_LAYOUT_COUNT || pHeader->mViewCount != GetImposterViewCount(pHeader->mViewLayout))
+			return false;
+
+		if (pHeader->mFrameCount == 0 || (uint64_t)pHeader->mFrameCount * pHeader->mViewCount > MaxImposterBakeSliceCount)
+			return false;
+
+		//Negated compares so NaN fails too.
+		if (!(pHeader->mSampleRate > 0.f) || !(pHeader->mSampleRate < FLT_MAX) || !(pHeader->mClipDuration > 0.f))
+			return false;
+
+		const uint64_t sliceCount = (uint64_t)pHeader->mFrameCount * pHeader->mViewCount;
+		const uint64_t dataStart = sizeof(ImposterBakeHeader) + sizeof(ImposterBakeSlice) * sliceCount;
+		if (fileSize < dataStart)
+			return false;
+
+		const uint64_t rawSize = (uint64_t)pHeader->mViewWidth * pHeader->mViewHeight * sizeof(uint32_t);
+		const ImposterBakeSlice* pSlices = (const ImposterBakeSlice*)(pBytes + sizeof(ImposterBakeHeader));
+		for (uint64_t i = 0; i < sliceCount; ++i)
+		{
+			const ImposterBakeSlice& slice = pSlices[i];
+			if (slice.mOffset < dataStart || slice.mOffset > fileSize || slice.mSize > fileSize - slice.mOffset ||
+				slice.mOffset % sizeof(uint32_t) != 0 || slice.mSize % sizeof(uint32_t) != 0)
+				return false;
+
+			if (pHeader->mCompression == IMPOSTER_BAKE_COMPRESSION_NONE && slice.mSize < rawSize)
+				return false;
+		}
+
+		return true;
+	}
+
+	void BakeVertexAnimation()
+	{
+		//Skin each clip sample once with the skinning compute and keep the result, frame f at f * frameSize.
+		DrainQueues();
+
+		const uint64_t frameSize = (uint64_t)pGeom->mVertexCount * SkinnedVertexStride;
+		Buffer* pSkinned = pBufferSkinnedVertices[gFrameIndex]->buffer;
+		Buffer* pVertexAnimation = pBufferVertexAnimation->buffer;
+		const float clipDuration = gClipController->mDuration;
+		//A rebake for another archetype finds the previous bake in the state it was left for the draw.
+		const bool rebake = gVatBakedArchetype != UINT32_MAX;
+
+		for (uint32_t frame = 0; frame < VatFrameCount; ++frame)
+		{
+			SamplePoseCache(clipDuration * (float)frame / (float)VatFrameCount, gStickFigureAnimObject->mRootTransform, gStickFigureAnimObject->mJointWorldMats.begin());
+			UpdateBonePalette();
+
+			resetCmdPool(renderer, pBakeCmdPool);
+			beginCmd(pBakeCmd);
+
+			UploadBonePalette(pBakeCmd);
+			RecordSkinningCompute(pBakeCmd);
+
+			BufferBarrier vatBarrier = { pVertexAnimation, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_COPY_DEST };
+			if (frame == 0 && rebake)
+				cmdResourceBarrier(pBakeCmd, 1, &vatBarrier, 0, NULL, 0, NULL);
+			vatBarrier = { pSkinned, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, RESOURCE_STATE_COPY_SOURCE };
+			cmdResourceBarrier(pBakeCmd, 1, &vatBarrier, 0, NULL, 0, NULL);
+			cmdUpdateBuffer(pBakeCmd, pVertexAnimation, frameSize * frame, pSkinned, 0, frameSize);
+			vatBarrier = { pSkinned, RESOURCE_STATE_COPY_SOURCE, RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+			cmdResourceBarrier(pBakeCmd, 1, &vatBarrier, 0, NULL, 0, NULL);
+
+			if (frame == VatFrameCount - 1)
+			{
+				vatBarrier = { pVertexAnimation, RESOURCE_STATE_COPY_DEST, RESOURCE_STATE_SHADER_RESOURCE };
+				cmdResourceBarrier(pBakeCmd, 1, &vatBarrier, 0, NULL, 0, NULL);
+			}
+
+			endCmd(pBakeCmd);
+
+			QueueSubmitDesc submitDesc = {};
+			submitDesc.mCmdCount = 1;
+			submitDesc.ppCmds = &pBakeCmd;
+			submitDesc.pSignalFence = pBakeFence;
+			queueSubmit(queue, &submitDesc);
+			waitForFences(renderer, 1, &pBakeFence);
+		}
+
+		gVatBakedArchetype = gLiveArchetype;
+		LOGF(eINFO, "Baked vertex animation: %u frames, %.1f MB", VatFrameCount, (float)(frameSize * VatFrameCount) / (1024.f * 1024.f));
+	}
+
+	void BakeImposters()
+	{
+		//Every archetype in turn, the live one last so its assets and bindings are what the bake leaves behind.
+		DrainQueues();
+		const uint32_t liveArchetype = gLiveArchetype;
+		for (uint32_t i = 1; i <= gImposterArchetypeCount; ++i)
+		{
+			const uint32_t archetype = (liveArchetype + i) % gImposterArchetypeCount;
+			SwitchLiveArchetype(archetype);
+			BakeArchetype(archetype);
+		}
+
+		//Pick up the fresh bakes right away.
+		if (!gImposterBakeAndExit && LoadImposterBakes())
+		{
+			waitForAllResourceLoads();
+			PrepareDescriptorSets();
+			gUIData.mGeneralSettings.mUseBakedImposters = true;
+		}
+	}
+
+	void BakeArchetype(uint32_t archetype)
+	{
+		//Sample the live clip at a fixed rate, capture every view of each sample and write the baked atlas file.
+		const uint32_t viewCount = gImposterAtlas.mViewCount;
+		const uint32_t frameCount = ImposterBakeFrameCount;
+		const uint32_t texelSize = TinyImageFormat_BitSizeOfBlock(gImposterAtlas.pColor->mFormat) / 8;
+		const uint32_t texelCount = gImposterAtlas.mViewWidth * gImposterAtlas.mViewHeight;
+		const uint64_t sliceSize = (uint64_t)texelCount * texelSize;
+		const float clipDuration = gClipController->mDuration;
+
+		//Copies rows tightly packed, the row pitch already satisfies the copy alignment.
+		ASSERT(texelSize == sizeof(uint32_t));
+		ASSERT((gImposterAtlas.mViewWidth * texelSize) % 256 == 0);
+
+		BufferLoadDesc readbackDesc{};
+		readbackDesc.mDesc.mDescriptors = DESCRIPTOR_TYPE_UNDEFINED;
+		readbackDesc.mDesc.mMemoryUsage = RESOURCE_MEMORY_USAGE_GPU_TO_CPU;
+		readbackDesc.mDesc.mFlags = BUFFER_CREATION_FLAG_PERSISTENT_MAP_BIT;
+		readbackDesc.mDesc.mStartState = RESOURCE_STATE_COPY_DEST;
+		readbackDesc.mDesc.mSize = sliceSize * viewCount;
+		readbackDesc.mDesc.pName = "ImposterBakeReadback";
+
+		Buffer* pReadbackBuffer = NULL;
+		readbackDesc.ppBuffer = &pReadbackBuffer;
+		addResource(&readbackDesc, NULL);
+		waitForAllResourceLoads();
+
+		ImposterBakeHeader header{};
+		header.mMagic = ImposterBakeMagic;
+		header.mVersion = ImposterBakeVersion;
+		header.mViewWidth = gImposterAtlas.mViewWidth;
+		header.mViewHeight = gImposterAtlas.mViewHeight;
+		header.mViewCount = viewCount;
+		header.mFrameCount = frameCount;
+		header.mFormat = (uint32_t)gImposterAtlas.pColor->mFormat;
+		header.mCompression = IMPOSTER_BAKE_COMPRESSION_ZERO_RLE;
+		header.mViewLayout = gImposterViewLayout;
+		header.mSampleRate = (float)frameCount / clipDuration;
+		header.mClipDuration = clipDuration;
+
+		const uint32_t sliceCount = frameCount * viewCount;
+		const uint64_t dataStart = sizeof(ImposterBakeHeader) + sizeof(ImposterBakeSlice) * sliceCount;
+		ImposterBakeSlice* pSlices = (ImposterBakeSlice*)tf_malloc(sizeof(ImposterBakeSlice) * sliceCount);
+
+		//Worst case is alternating empty and filled texels.
+		uint32_t* pCompressed = (uint32_t*)tf_malloc((texelCount * 2 + 2) * sizeof(uint32_t));
+		uint8_t* pData = NULL;
+		uint64_t dataSize = 0;
+
+		const float savedTime = gUIData.mClip.mAnimationTime;
+
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			//Pose on the CPU, the bake has no frame in flight to hide the accelerator behind.
+			gClipController->SetTimeRatioHard((float)frame / header.mSampleRate);
+			gStickFigureAnimObject->Update(0.f);
+			gStickFigureAnimObject->ComputePose(gStickFigureAnimObject->mRootTransform);
+
+			UpdateBonePalette();
+			ScheduleFullCapture();
+
+			resetCmdPool(renderer, pBakeCmdPool);
+			beginCmd(pBakeCmd);
+
+			UploadBonePalette(pBakeCmd);
+			gPosedMeshReady = gUIData.mGeneralSettings.mPreSkinCompute;
+			if (gPosedMeshReady)
+				RecordSkinningCompute(pBakeCmd);
+
+			RenderTargetBarrier atlasBarrier = { gImposterAtlas.pColor, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_RENDER_TARGET };
+			cmdResourceBarrier(pBakeCmd, 0, NULL, 0, NULL, 1, &atlasBarrier);
+			RecordImposterCapture(pBakeCmd);
+			atlasBarrier = { gImposterAtlas.pColor, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_SHADER_RESOURCE };
+			cmdResourceBarrier(pBakeCmd, 0, NULL, 0, NULL, 1, &atlasBarrier);
+
+			endCmd(pBakeCmd);
+
+			QueueSubmitDesc submitDesc = {};
+			submitDesc.mCmdCount = 1;
+			submitDesc.ppCmds = &pBakeCmd;
+			submitDesc.pSignalFence = pBakeFence;
+			queueSubmit(queue, &submitDesc);
+			waitForFences(renderer, 1, &pBakeFence);
+
+			SyncToken copyToken = {};
+			for (uint32_t view = 0; view < viewCount; ++view)
+			{
+				TextureCopyDesc copyDesc = {};
+				copyDesc.pTexture = gImposterAtlas.pColor->pTexture;
+				copyDesc.pBuffer = pReadbackBuffer;
+				copyDesc.mTextureArrayLayer = view;
+				copyDesc.mTextureMipLevel = 0;
+				copyDesc.mTextureState = RESOURCE_STATE_SHADER_RESOURCE;
+				copyDesc.mQueueType = QUEUE_TYPE_GRAPHICS;
+				copyDesc.mBufferOffset = sliceSize * view;
+				copyResource(&copyDesc, &copyToken);
+			}
+			waitForToken(&copyToken);
+
+			const uint8_t* pReadback = (const uint8_t*)pReadbackBuffer->pCpuMappedAddress;
+			for (uint32_t view = 0; view < viewCount; ++view)
+			{
+				uint32_t words = CompressImposterSlice((const uint32_t*)(pReadback + sliceSize * view), texelCount, pCompressed);
+				uint64_t size = (uint64_t)words * sizeof(uint32_t);
+
+				ImposterBakeSlice& slice = pSlices[frame * viewCount + view];
+				slice.mOffset = dataStart + dataSize;
+				slice.mSize = size;
+
+				pData = (uint8_t*)tf_realloc(pData, dataSize + size);
+				memcpy(pData + dataSize, pCompressed, size);
+				dataSize += size;
+			}
+		}
+
+		gClipController->SetTimeRatioHard(savedTime);
+		removeResource(pReadbackBuffer);
+		tf_free(pCompressed);
+
+		const char* pBakeFile = gImposterArchetypeDescs[archetype].pBakeFile;
+		FileStream bakeFile = {};
+		if (fsOpenStreamFromPath(RD_OTHER_FILES, pBakeFile, FM_WRITE_BINARY, NULL, &bakeFile))
+		{
+			fsWriteToStream(&bakeFile, &header, sizeof(header));
+			fsWriteToStream(&bakeFile, pSlices, sizeof(ImposterBakeSlice) * sliceCount);
+			fsWriteToStream(&bakeFile, pData, dataSize);
+			fsCloseStream(&bakeFile);
+
+			LOGF(eINFO, "Baked %u frames x %u views of imposters into %s (%llu bytes)", frameCount, viewCount, pBakeFile, (unsigned long long)(dataStart + dataSize));
+		}
+		else
+		{
+			LOGF(eERROR, "Could not open %s for writing", pBakeFile);
+		}
+
+		tf_free(pSlices);
+		tf_free(pData);
+	}
+
+	bool LoadImposterBakes()
+	{
+		//The live archetype's bake sets the shared header, the other archetypes must match it.
+		if (!LoadImposterBake(gLiveArchetype))
+			return false;
+
+		uint32_t loadedCount = 1;
+		for (uint32_t i = 0; i < gImposterArchetypeCount; ++i)
+		{
+			if (i != gLiveArchetype && LoadImposterBake(i))
+				++loadedCount;
+		}
+
+		LOGF(eINFO, "Loaded imposter bakes for %u / %u archetypes", loadedCount, gImposterArchetypeCount);
+		return true;
+	}
+
+	bool LoadImposterBake(uint32_t archetype)
+	{
+		//Memory map the baked atlas file and stream every slice into one texture array.
+		const char* pBakeFile = gImposterArchetypeDescs[archetype].pBakeFile;
+		FileStream bakeFile = {};
+		if (!fsOpenStreamFromPath(RD_OTHER_FILES, pBakeFile, FM_READ_BINARY, NULL, &bakeFile))
+			return false;
+
+		size_t fileSize = 0;
+		const void* pMapped = NULL;
+		uint8_t* pFileData = NULL;
+		if (!fsStreamMemoryMap(&bakeFile, &fileSize, &pMapped))
+		{
+			//No mapping on this platform, fall back to one read.
+			fileSize = (size_t)fsGetStreamFileSize(&bakeFile);
+			pFileData = (uint8_t*)tf_malloc(fileSize);
+			fileSize = fsReadFromStream(&bakeFile, pFileData, fileSize);
+			pMapped = pFileData;
+		}
+
+		const uint8_t* pBytes = (const uint8_t*)pMapped;
+		if (!ValidateImposterBake(pBytes, fileSize))
+		{
+			LOGF(eERROR, "%s is not a valid imposter bake (version %u expected)", pBakeFile, ImposterBakeVersion);
+			if (pFileData)
+				tf_free(pFileData);
+			fsCloseStream(&bakeFile);
+			return false;
+		}
+
+		Texture*& pImposterBakeTexture = pImposterBakeTextures[archetype];
+		if (pImposterBakeTexture)
+		{
+			DrainQueues();
+			removeResource(pImposterBakeTexture);
+			pImposterBakeTexture = NULL;
+		}
+
+		//Every archetype draws in the same pass with the same frame and view lookup.
+		const ImposterBakeHeader* pHeader = (const ImposterBakeHeader*)pBytes;
+		const ImposterBakeHeader& shared = gImposterBakeHeader;
+		if (archetype != gLiveArchetype && (pHeader->mFrameCount != shared.mFrameCount || pHeader->mViewCount != shared.mViewCount ||
+			pHeader->mViewLayout != shared.mViewLayout || pHeader->mSampleRate != shared.mSampleRate))
+		{
+			LOGF(eERROR, "%s was baked with a different frame or view layout than %s, rebake it", pBakeFile, gImposterArchetypeDescs[gLiveArchetype].pBakeFile);
+			if (pFileData)
+				tf_free(pFileData);
+			fsCloseStream(&bakeFile);
+			return false;
+		}
+
+		const uint32_t texelCount = pHeader->mViewWidth * pHeader->mViewHeight;
+		const uint32_t sliceCount = pHeader->mFrameCount * pHeader->mViewCount;
+		const ImposterBakeSlice* pSlices = (const ImposterBakeSlice*)(pBytes + sizeof(ImposterBakeHeader));
+
+		TextureDesc bakeTextureDesc{};
+		bakeTextureDesc.mArraySize = sliceCount;
+		bakeTextureDesc.mDepth = 1;
+		bakeTextureDesc.mWidth = pHeader->mViewWidth;
+		bakeTextureDesc.mHeight = pHeader->mViewHeight;
+		bakeTextureDesc.mMipLevels = 1;
+		bakeTextureDesc.mSampleCount = SAMPLE_COUNT_1;
+		bakeTextureDesc.mFormat = (TinyImageFormat)pHeader->mFormat;
+		bakeTextureDesc.mStartState = RESOURCE_STATE_SHADER_RESOURCE;
+		bakeTextureDesc.mDescriptors = DESCRIPTOR_TYPE_TEXTURE;
+		bakeTextureDesc.pName = "Imposter Bake";
+
+		TextureLoadDesc bakeTextureLoadDesc{};
+		bakeTextureLoadDesc.pDesc = &bakeTextureDesc;
+		bakeTextureLoadDesc.ppTexture = &pImposterBakeTexture;
+		addResource(&bakeTextureLoadDesc, NULL);
+
+		uint32_t* pTexels = (uint32_t*)tf_malloc(texelCount * sizeof(uint32_t));
+		const uint32_t rowSize = pHeader->mViewWidth * sizeof(uint32_t);
+
+		bool decompressed = true;
+		for (uint32_t i = 0; i < sliceCount && decompressed; ++i)
+		{
+			const uint32_t* pSliceData = (const uint32_t*)(pBytes + pSlices[i].mOffset);
+			if (pHeader->mCompression == IMPOSTER_BAKE_COMPRESSION_ZERO_RLE)
+				decompressed = DecompressImposterSlice(pSliceData, pSlices[i].mSize / sizeof(uint32_t), texelCount, pTexels);
+			else
+				memcpy(pTexels, pSliceData, texelCount * sizeof(uint32_t));
+
+			if (!decompressed)
+			{
+				LOGF(eERROR, "%s slice %u is corrupt, run past the end of the slice", pBakeFile, i);
+				break;
+			}
+
+			TextureUpdateDesc updateDesc = { pImposterBakeTexture };
+			updateDesc.mBaseMipLevel = 0;
+			updateDesc.mMipLevels = 1;
+			updateDesc.mBaseArrayLayer = i;
+			updateDesc.mLayerCount = 1;
+			updateDesc.mCurrentState = RESOURCE_STATE_SHADER_RESOURCE;
+			beginUpdateResource(&updateDesc);
+
+			TextureSubresourceUpdate subresource = updateDesc.getSubresourceUpdateDesc(0, 0);
+			for (uint32_t row = 0; row < subresource.mRowCount; ++row)
+				memcpy(subresource.pMappedData + row * subresource.mDstRowStride, (uint8_t*)pTexels + row * rowSize, rowSize);
+
+			endUpdateResource(&updateDesc, NULL);
+		}
+
+		if (decompressed)
+		{
+			if (archetype == gLiveArchetype)
+				gImposterBakeHeader = *pHeader;
+			gImposterBakeHeaders[archetype] = *pHeader;
+			LOGF(eINFO, "Loaded imposter bake %s : %u frames x %u views", pBakeFile, pHeader->mFrameCount, pHeader->mViewCount);
+		}
+		else
+		{
+			//Slices already queued still reference the texture.
+			waitForAllResourceLoads();
+			removeResource(pImposterBakeTexture);
+			pImposterBakeTexture = NULL;
+		}
+
+		tf_free(pTexels);
+		if (pFileData)
+			tf_free(pFileData);
+		fsCloseStream(&bakeFile);
+
+		return decompressed;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
+	//									Other Funcs 								  //
+	////////////////////////////////////////////////////////////////////////////////////
+	bool AdvanceCaptureTick()
+	{
+		//Fixed step accumulator on the frame delta, a rate of 0 captures every frame.
+		const int tickRate = gUIData.mGeneralSettings.captureTickRate;
+		if (tickRate <= 0)
+		{
+			gCaptureTickAccumulator = 0.f;
+			return true;
+		}
+
+		const float step = 1.f / (float)tickRate;
+		gCaptureTickAccumulator += dtSave;
+		if (gCaptureTickAccumulator < step)
+			return false;
+
+		//One capture covers every step a long frame skipped, no catch up bursts.
+		gCaptureTickAccumulator = fmodf(gCaptureTickAccumulator, step);
+		return true;
+	}
+
+	void ScheduleImposterCapture()
+	{
+		//Choose this frame's capture views from the budget and the views visible imposters referenced.
+		ImposterCaptureScheduler& scheduler = gCaptureScheduler;
+		const uint32_t viewCount = gImposterAtlas.mViewCount;
+		const uint32_t budget = min((uint32_t)gUIData.mGeneralSettings.captureViewsPerFrame, viewCount);
+
+		++scheduler.mFrameStamp;
+		scheduler.mRefreshCount = 0;
+
+		//Usage of the frame that last used this slot, its fence has been waited on.
+		pBufferAngleBinReadback[gFrameIndex]->ReadData(angleBinUsage);
+		const uint32_t usageStamp = scheduler.mReadbackStamps[gFrameIndex];
+
+		bool scheduled[TextureCount] = {};
+		uint32_t visibleViews[TextureCount];
+		uint32_t visibleCount = 0;
+
+		scheduler.mMaxVisibleStaleness = 0;
+		scheduler.mMaxStaleness = 0;
+
+		for (uint32_t i = 0; i < viewCount; ++i)
+		{
+			uint32_t staleness = scheduler.mFrameStamp - scheduler.mLastCaptureStamp[i];
+			scheduler.mMaxStaleness = max(scheduler.mMaxStaleness, staleness);
+
+			if (usageStamp != 0 && angleBinUsage[i] == usageStamp)
+			{
+				visibleViews[visibleCount++] = i;
+				scheduler.mMaxVisibleStaleness = max(scheduler.mMaxVisibleStaleness, staleness);
+			}
+		}
+		scheduler.mVisibleViewCount = visibleCount;
+
+		if (budget == viewCount)
+		{
+			ScheduleFullCapture();
+			return;
+		}
+
+		//Stalest visible views first.
+		for (uint32_t i = 1; i < visibleCount; ++i)
+		{
+			uint32_t view = visibleViews[i];
+			uint32_t j = i;
+			while (j > 0 && scheduler.mLastCaptureStamp[visibleViews[j - 1]] > scheduler.mLastCaptureStamp[view])
+			{
+				visibleViews[j] = visibleViews[j - 1];
+				--j;
+			}
+			visibleViews[j] = view;
+		}
+
+		for (uint32_t i = 0; i < visibleCount && scheduler.mRefreshCount < budget; ++i)
+		{
+			scheduled[visibleViews[i]] = true;
+			scheduler.mRefreshViews[scheduler.mRefreshCount++] = visibleViews[i];
+		}
+
+		//Leftover budget keeps the unseen views from going too stale.
+		const uint32_t cursor = scheduler.mRoundRobinCursor;
+		for (uint32_t i = 0; i < viewCount && scheduler.mRefreshCount < budget; ++i)
+		{
+			uint32_t view = (cursor + i) % viewCount;
+			if (scheduled[view])
+				continue;
+
+			scheduled[view] = true;
+			scheduler.mRefreshViews[scheduler.mRefreshCount++] = view;
+			scheduler.mRoundRobinCursor = (view + 1) % viewCount;
+		}
+
+		for (uint32_t i = 0; i < scheduler.mRefreshCount; ++i)
+			scheduler.mLastCaptureStamp[scheduler.mRefreshViews[i]] = scheduler.mFrameStamp;
+
+		pBufferCaptureViewList[gFrameIndex]->UpdateData(scheduler.mRefreshViews);
+	}
+
+	void ScheduleFullCapture()
+	{
+		//Every view, in slice order.
+		ImposterCaptureScheduler& scheduler = gCaptureScheduler;
+
+		scheduler.mRefreshCount = 0;
+		for (uint32_t i = 0; i < gImposterAtlas.mViewCount; ++i)
+		{
+			scheduler.mRefreshViews[scheduler.mRefreshCount++] = i;
+			scheduler.mLastCaptureStamp[i] = scheduler.mFrameStamp;
+		}
+
+		pBufferCaptureViewList[gFrameIndex]->UpdateData(scheduler.mRefreshViews);
+	}
+
+	int GetXZAngle(bool& left)
+	{
+		//XZ angle computing btw center animating object & camera for debugging purpose.
+		vec3 boPosition = vec3(0.f, 0.f, 0.f);
+		vec3 boDirection = vec3(0.f, 0.f, 1.f);
+		vec3 eyePos = mainCamera->getViewPosition();
+		vec3 boToCam = eyePos - boPosition;
+
+		boDirection.setY(0.f);
+		boToCam.setY(0.f);
+
+		boToCam = normalize(boToCam);
+		boDirection = normalize(boDirection);
+
+		float cosTheta = dot(boToCam, boDirection);
+		float theta = acos(cosTheta);
+		float angleInDegree = radToDeg(theta);
+
+		vec3 camDir = -boDirection;
+		vec3 targetDir = boPosition - eyePos;
+		vec3 crossResult = cross(camDir, targetDir);
+
+		left = crossResult.getY() > 0.f ? true : false;
+
+		if (left)
+			angleInDegree = 180.f + (180.f - angleInDegree);
+
+		return static_cast<int>(angleInDegree);
+	}
+
+	float GetYAngle()
+	{
+		//Y angle computing btw center animating object & camera for debugging purpose.
 		vec3 boPosition = vec3(0.f, 0.f, 0.f);
 		vec3 boDirection = vec3(0.f, 1.f, 0.f);
 		vec3 eyePos = mainCamera->getViewPosition();
@@ -2291,27 +7188,55 @@ class ImposterRendering: public IApp
 	//Tried Optimize, put ComputePose Func to the compute shader.
 	void UpdateAnims(Cmd* cmd, ProfileToken* pToken)
 	{
-		cmdBeginGpuTimestampQuery(cmd, NULL, "Skinning calc time");
+		cmdBeginGpuTimestampQuery(cmd, *pToken, "Skinning calc time");
 
-		//Update the animated object for this frame.
-		if (!gStickFigureAnimObject->Update(dtSave))
+		//Update the animated object for this frame, the pose cache only needs the clip time advanced.
+		if (UsingPoseCache())
+			gClipController->Update(dtSave);
+		else if (!gStickFigureAnimObject->Update(dtSave))
 			LOGF(eINFO, "Animation Not Updating");
 
-		//Pose the rig based on the animated object's updated values.
-		if (!gUIData.mGeneralSettings.mShowBindPose && gUIData.mGeneralSettings.mOptimizeAnimSim)
+		//Pose the rig based on the animated object's updated values, the accelerator also builds the palette.
+		if (GpuAnimationPalette())
 			DispatchAnimAccelCompute(cmd);
-		else if(!gUIData.mGeneralSettings.mShowBindPose && !gUIData.mGeneralSettings.mOptimizeAnimSim)
-			gStickFigureAnimObject->ComputePose(gStickFigureAnimObject->mRootTransform);
-		//Ignore the updated values and pose in bind
 		else
-			gStickFigureAnimObject->ComputeBindPose(gStickFigureAnimObject->mRootTransform);
-
-		for (unsigned i = 0; i < pGeomData->mJointCount; ++i)
 		{
-			gUniformDataBones.mBoneMatrix[i] = gStickFigureAnimObject->mJointWorldMats[pGeomData->pJointRemaps[i]] * pGeomData->pInverseBindPoses[i];
+			//Crowd goes wide on the workers while this thread poses the main character.
+			KickCrowdAnims();
+
+			if (UsingPoseCache())
+				SamplePoseCache(gUIData.mClip.mAnimationTime, gStickFigureAnimObject->mRootTransform, gStickFigureAnimObject->mJointWorldMats.begin());
+			else if (!gUIData.mGeneralSettings.mShowBindPose)
+				gStickFigureAnimObject->ComputePose(gStickFigureAnimObject->mRootTransform);
+			//Ignore the updated values and pose in bind
+			else
+				gStickFigureAnimObject->ComputeBindPose(gStickFigureAnimObject->mRootTransform);
+
+			UpdateBonePalette();
+			UploadBonePalette(cmd);
+
+			waitThreadSystemIdle(pThreadSystem);
+			getHiresTimerUSec(&gCrowdAnimTimer, true);
 		}
 
-		cmdEndGpuTimestampQuery(cmd, NULL);
+		cmdEndGpuTimestampQuery(cmd, *pToken);
+	}
+
+	void KickCrowdAnims()
+	{
+		//Small batches let idle workers pick up the remaining objects, this slot's fence has already signaled.
+		resetHiresTimer(&gCrowdAnimTimer);
+		gCrowdAnimTaskData.mDeltaTime = dtSave;
+		gCrowdAnimTaskData.mBindPose = gUIData.mGeneralSettings.mShowBindPose;
+		gCrowdAnimTaskData.mUsePoseCache = UsingPoseCache();
+		//Only the near field draw reads the crowd palettes.
+		gCrowdAnimTaskData.mCount = NearFieldActive() ? (uint32_t)gUIData.mGeneralSettings.crowdAnimCount : 0;
+		gCrowdAnimTaskData.mFormat = gBonePaletteFormat;
+		gCrowdAnimTaskData.pPalettes = (vec4*)pBufferCrowdPalettes[gFrameIndex]->buffer->pCpuMappedAddress;
+
+		const uint32_t batchCount = (gCrowdAnimTaskData.mCount + CrowdAnimTaskBatch - 1) / CrowdAnimTaskBatch;
+		if (batchCount)
+			addThreadSystemRangeTask(pThreadSystem, UpdateCrowdAnimTask, &gCrowdAnimTaskData, batchCount);
 	}
 
 	const char* GetName() { return "Imposter Rendering"; }
@@ -0,0 +1,44 @@
+/*
+* Copyright (c) 2017-2023 The Forge Interactive Inc.
+*
+* This file is part of The-Forge
+* (see https://github.com/ConfettiFX/The-Forge).
+*
+* Licensed to the Apache Software Foundation (ASF) under one
+* or more contributor license agreements.  See the NOTICE file
+* distributed with this work for additional information
+* regarding copyright ownership.  The ASF licenses this file
+* to you under the Apache License, Version 2.0 (the
+* "License"); you may not use this file except in compliance
+* with the License.  You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+* KIND, either express or implied.  See the License for the
+* specific language governing permissions and limitations
+* under the License.
+*/
+
+#ifndef SHARED_H
+#define SHARED_H
+
+//Included by the application and by the FSL shaders, keep it to plain defines.
+
+//Bone palette capacity of the skinning shaders and the CPU palette.
+#define MAX_NUM_BONES 256
+
+//Clustered culling runs one angle compute group per visible cluster, a group has to cover a whole cluster.
+#define AngleComputeGroupSize 128
+
+//Distance bins the angle compute counts near field candidates in, the buffer holds one more counter after them.
+#define NearFieldHistogramBinCount 64
+
+//Imposter archetypes the bindless texture heap has slots for.
+#define MaxImposterArchetypes 16
+//Live atlases of every archetype, then their baked atlases.
+#define ImposterTextureHeapSize (MaxImposterArchetypes * 2)
+
+#endif